@@ -4,3 +4,16 @@
 #include "FocusableObject.h"
 
 // Add default functionality here for any IFocusableObject functions that are not pure virtual.
+
+void IFocusableObject::OnNewTransformations_Implementation(ATransformerPawn* Caller
+	, const TArray<USceneComponent*>& Components, const TArray<FTransform>& NewTransforms, bool bComponentBased)
+{
+	UObject* focusableObject = _getUObject();
+	for (int32 i = 0; i < Components.Num(); ++i)
+		Execute_OnNewTransformation(focusableObject, Caller, Components[i], NewTransforms[i], bComponentBased);
+}
+
+bool IFocusableObject::WantsBatchedTransformations_Implementation() const
+{
+	return false;
+}
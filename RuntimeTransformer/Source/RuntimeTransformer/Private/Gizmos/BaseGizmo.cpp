@@ -5,7 +5,11 @@
 #include "Components/SceneComponent.h"
 #include "Components/ShapeComponent.h"
 #include "Components/BoxComponent.h"
+#include "Components/SphereComponent.h"
 #include "Engine/World.h"
+#include "TransformerMath.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Skipped Gizmo Updates"), STAT_SkippedGizmoUpdates, STATGROUP_RuntimeTransformer);
 
 // Sets default values
 ABaseGizmo::ABaseGizmo()
@@ -33,12 +37,26 @@ ABaseGizmo::ABaseGizmo()
 
 	GizmoSceneScaleFactor = 0.1f;
 	CameraArcRadius = 150.f;
+	CameraLocationTolerance = 0.1f;
+	CameraAngleTolerance = 0.01f;
+
+	LastReferenceLocation = FVector::ZeroVector;
+	LastReferenceLookDirection = FVector::ZeroVector;
+	LastFieldOfView = 0.f;
+	LastSpaceType = ESpaceType::ST_None;
+	bGizmoSceneScaleDirty = true;
+	bGizmoSpaceDirty = true;
+	bAttachmentSnapPending = false;
+	bTickWhileIdle = true;
 
 	PreviousRayStartPoint = FVector::ZeroVector;
 	PreviousRayEndPoint = FVector::ZeroVector;
 
 	bTransformInProgress = false;
 	bIsPrevRayValid = false;
+	bGizmoEnabled = true;
+	bHandleCollisionEnabled = true;
+	HoveredDomain = ETransformationDomain::TD_None;
 }
 
 void ABaseGizmo::Tick(float DeltaSeconds)
@@ -46,10 +64,75 @@ void ABaseGizmo::Tick(float DeltaSeconds)
 	Super::Tick(DeltaSeconds);
 
 	//ToDo: There seems to be an issue where the Root Scene doesn't Attach properly on the first 'go' on Unreal 4.26
-	if (RootScene)
+	// so snap it once more on the Tick after it was attached
+	if (bAttachmentSnapPending)
+	{
+		bAttachmentSnapPending = false;
+		if (RootScene && RootScene->GetAttachParent())
+		{
+			RootScene->AttachToComponent(RootScene->GetAttachParent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+			bGizmoSpaceDirty = true;
+			RefreshGizmoSpace(LastSpaceType);
+		}
+		UpdateTickEnabled();
+	}
+}
+
+void ABaseGizmo::SetGizmoAttachParent(USceneComponent* AttachParent)
+{
+	if (GizmoAttachParent.Get() != AttachParent)
+	{
+		if (GizmoAttachParent.IsValid())
+			GizmoAttachParent->TransformUpdated.Remove(AttachParentTransformHandle);
+		AttachParentTransformHandle.Reset();
+		GizmoAttachParent = AttachParent;
+
+		if (AttachParent)
+			AttachParentTransformHandle = AttachParent->TransformUpdated.AddUObject(this, &ABaseGizmo::OnAttachParentTransformUpdated);
+	}
+
+	if (AttachParent)
+	{
+		AttachToComponent(AttachParent, FAttachmentTransformRules::SnapToTargetIncludingScale);
+		bAttachmentSnapPending = true;
+	}
+	else
 	{
-		RootScene->AttachToComponent(RootScene->GetAttachParent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+		DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		bAttachmentSnapPending = false;
 	}
+
+	bGizmoSpaceDirty = true;
+	bGizmoSceneScaleDirty = true;
+	UpdateTickEnabled();
+}
+
+void ABaseGizmo::OnAttachParentTransformUpdated(USceneComponent* UpdatedComponent
+	, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	//the Gizmo moved along with its Parent, so it needs to be rescaled
+	bGizmoSceneScaleDirty = true;
+
+	//and World Space has to counter the new Parent Rotation right away
+	if (LastSpaceType != ESpaceType::ST_None)
+	{
+		bGizmoSpaceDirty = true;
+		RefreshGizmoSpace(LastSpaceType);
+	}
+}
+
+void ABaseGizmo::RefreshGizmoSpace(ESpaceType SpaceType)
+{
+	if (!bGizmoSpaceDirty && SpaceType == LastSpaceType)
+	{
+		INC_DWORD_STAT(STAT_SkippedGizmoUpdates);
+		return;
+	}
+
+	bGizmoSpaceDirty = false;
+	LastSpaceType = SpaceType;
+	UpdateGizmoSpace(SpaceType);
+	bGizmoSceneScaleDirty = true;
 }
 
 void ABaseGizmo::UpdateGizmoSpace(ESpaceType SpaceType)
@@ -79,6 +162,20 @@ FTransform ABaseGizmo::GetDeltaTransform(const FVector& LookingVector
 
 void ABaseGizmo::ScaleGizmoScene(const FVector& ReferenceLocation, const FVector& ReferenceLookDirection, float FieldOfView)
 {
+	if (!bGizmoSceneScaleDirty
+		&& FVector::DistSquared(ReferenceLocation, LastReferenceLocation) <= FMath::Square(CameraLocationTolerance)
+		&& FMath::Abs(FieldOfView - LastFieldOfView) <= CameraAngleTolerance
+		&& FVector::DotProduct(ReferenceLookDirection, LastReferenceLookDirection) >= FMath::Cos(FMath::DegreesToRadians(CameraAngleTolerance)))
+	{
+		INC_DWORD_STAT(STAT_SkippedGizmoUpdates);
+		return;
+	}
+
+	bGizmoSceneScaleDirty = false;
+	LastReferenceLocation = ReferenceLocation;
+	LastReferenceLookDirection = ReferenceLookDirection;
+	LastFieldOfView = FieldOfView;
+
 	FVector Scale = CalculateGizmoSceneScale(ReferenceLocation, ReferenceLookDirection, FieldOfView);
 	//UE_LOG(LogRuntimeTransformer, Warning, TEXT("Scale: %s"), *Scale.ToString());
 	if (ScalingScene)
@@ -108,6 +205,71 @@ ETransformationDomain ABaseGizmo::GetTransformationDomain(USceneComponent* Compo
 	return ETransformationDomain::TD_None;
 }
 
+ETransformationDomain ABaseGizmo::TraceDomain(const FVector& RayStart, const FVector& RayEnd) const
+{
+	ETransformationDomain closestDomain = ETransformationDomain::TD_None;
+	float closestTime = TNumericLimits<float>::Max();
+
+	for (const auto& handle : DomainMap)
+	{
+		const UShapeComponent* shape = handle.Key;
+		if (!IsValid(shape) || !shape->IsVisible()) continue;
+
+		//the Ray Time is the same in Local Space, since the Component Transform is affine
+		const FTransform& componentTransform = shape->GetComponentTransform();
+		const FVector localStart = componentTransform.InverseTransformPosition(RayStart);
+		const FVector localDirection = componentTransform.InverseTransformPosition(RayEnd) - localStart;
+
+		float time;
+		if (IntersectHandle(shape, handle.Value, localStart, localDirection, time) && time < closestTime)
+		{
+			closestTime = time;
+			closestDomain = handle.Value;
+		}
+	}
+	return closestDomain;
+}
+
+bool ABaseGizmo::IntersectHandle(const UShapeComponent* Handle, ETransformationDomain Domain
+	, const FVector& LocalRayStart, const FVector& LocalRayDirection, float& outTime) const
+{
+	if (const UBoxComponent* box = Cast<UBoxComponent>(Handle))
+	{
+		const FVector extent = box->GetUnscaledBoxExtent();
+		return FTransformerMath::IntersectRayBox(LocalRayStart, LocalRayDirection, FBox(-extent, extent), outTime);
+	}
+
+	if (const USphereComponent* sphere = Cast<USphereComponent>(Handle))
+	{
+		//|Start + t * Direction|^2 = Radius^2
+		const float radius = sphere->GetUnscaledSphereRadius();
+		const float a = LocalRayDirection.SizeSquared();
+		const float b = 2.f * FVector::DotProduct(LocalRayStart, LocalRayDirection);
+		const float c = LocalRayStart.SizeSquared() - radius * radius;
+		if (c <= 0.f)
+		{
+			outTime = 0.f; //starts inside
+			return true;
+		}
+		const float discriminant = b * b - 4.f * a * c;
+		if (a <= SMALL_NUMBER || discriminant < 0.f) return false;
+		outTime = (-b - FMath::Sqrt(discriminant)) / (2.f * a);
+		return outTime >= 0.f && outTime <= 1.f;
+	}
+
+	return false;
+}
+
+void ABaseGizmo::UpdateHoveredDomain(const FVector& RayStart, const FVector& RayEnd)
+{
+	const ETransformationDomain domain = TraceDomain(RayStart, RayEnd);
+	if (domain != HoveredDomain)
+	{
+		HoveredDomain = domain;
+		OnGizmoHoverChange.Broadcast(GetGizmoType(), HoveredDomain);
+	}
+}
+
 FVector ABaseGizmo::CalculateGizmoSceneScale(const FVector& ReferenceLocation, const FVector& ReferenceLookDirection, float FieldOfView)
 {
 	FVector deltaLocation = (GetActorLocation() - ReferenceLocation);
@@ -140,6 +302,43 @@ void ABaseGizmo::RegisterDomainComponent(USceneComponent* Component
 		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Failed to Register Component! Component is not a Shape Component %s"), *Component->GetName());
 }
 
+void ABaseGizmo::SetGizmoEnabled(bool bEnabled)
+{
+	if (bGizmoEnabled == bEnabled) return;
+	bGizmoEnabled = bEnabled;
+
+	SetActorHiddenInGame(!bEnabled);
+	SetActorEnableCollision(bEnabled && bHandleCollisionEnabled);
+
+	if (!bEnabled)
+	{
+		SetGizmoAttachParent(nullptr);
+		HoveredDomain = ETransformationDomain::TD_None;
+		bTransformInProgress = false;
+		bIsPrevRayValid = false;
+		LastSpaceType = ESpaceType::ST_None;
+	}
+
+	UpdateTickEnabled();
+}
+
+void ABaseGizmo::SetHandleCollisionEnabled(bool bEnabled)
+{
+	bHandleCollisionEnabled = bEnabled;
+	SetActorEnableCollision(bGizmoEnabled && bHandleCollisionEnabled);
+}
+
+void ABaseGizmo::SetTickWhileIdle(bool bInTickWhileIdle)
+{
+	bTickWhileIdle = bInTickWhileIdle;
+	UpdateTickEnabled();
+}
+
+void ABaseGizmo::UpdateTickEnabled()
+{
+	SetActorTickEnabled(bGizmoEnabled && (bTickWhileIdle || bAttachmentSnapPending));
+}
+
 void ABaseGizmo::SetTransformProgressState(bool bInProgress
 	, ETransformationDomain CurrentDomain)
 {
@@ -147,6 +346,7 @@ void ABaseGizmo::SetTransformProgressState(bool bInProgress
 	{
 		bIsPrevRayValid = false; //set this so that we don't get an invalid delta value
 		bTransformInProgress = bInProgress;
+		bGizmoSceneScaleDirty = true; //scale may depend on whether a Transform is in progress (e.g. Rotation Gizmo)
 		OnGizmoStateChange.Broadcast(GetGizmoType(), bTransformInProgress, CurrentDomain);
 	}
 }
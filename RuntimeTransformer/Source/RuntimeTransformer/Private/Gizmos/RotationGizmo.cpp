@@ -1,10 +1,37 @@
 // Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
 
 #include "Gizmos/RotationGizmo.h"
+#include "Components/BoxComponent.h"
 
 ARotationGizmo::ARotationGizmo()
 {
 	PreviousRotationViewScale = FVector::OneVector;
+	RingInnerRadiusRatio = 0.f;
+}
+
+bool ARotationGizmo::IntersectHandle(const UShapeComponent* Handle, ETransformationDomain Domain
+	, const FVector& LocalRayStart, const FVector& LocalRayDirection, float& outTime) const
+{
+	const UBoxComponent* box = Cast<UBoxComponent>(Handle);
+	if (!box) return Super::IntersectHandle(Handle, Domain, LocalRayStart, LocalRayDirection, outTime);
+
+	//Ring Normal is the thinnest side of the Box
+	const FVector extent = box->GetUnscaledBoxExtent();
+	const int32 normalAxis = (extent.X <= extent.Y && extent.X <= extent.Z) ? 0
+		: (extent.Y <= extent.Z) ? 1 : 2;
+	const int32 axisA = (normalAxis + 1) % 3;
+	const int32 axisB = (normalAxis + 2) % 3;
+
+	if (FMath::IsNearlyZero(LocalRayDirection[normalAxis])) return false;
+
+	outTime = -LocalRayStart[normalAxis] / LocalRayDirection[normalAxis];
+	if (outTime < 0.f || outTime > 1.f) return false;
+
+	const FVector hit = LocalRayStart + outTime * LocalRayDirection;
+	const float outerRadius = FMath::Min(extent[axisA], extent[axisB]);
+	const float innerRadius = outerRadius * RingInnerRadiusRatio;
+	const float radiusSquared = FMath::Square(hit[axisA]) + FMath::Square(hit[axisB]);
+	return radiusSquared <= FMath::Square(outerRadius) && radiusSquared >= FMath::Square(innerRadius);
 }
 
 FVector ARotationGizmo::CalculateGizmoSceneScale(const FVector& ReferenceLocation
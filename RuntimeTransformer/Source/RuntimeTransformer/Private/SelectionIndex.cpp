@@ -0,0 +1,493 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "SelectionIndex.h"
+#include "RuntimeTransformer.h"
+#include "TransformerMath.h"
+#include "Components/PrimitiveComponent.h"
+#include "ConvexVolume.h"
+
+DECLARE_CYCLE_STAT(TEXT("Selection Index Raycast"), STAT_SelectionIndexRaycast, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Selection Index Volume Query"), STAT_SelectionIndexVolumeQuery, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Index Reinsertions"), STAT_SelectionIndexReinsertions, STATGROUP_RuntimeTransformer);
+
+static float GetSurfaceArea(const FBox& Box)
+{
+	const FVector size = Box.GetSize();
+	return 2.f * (size.X * size.Y + size.Y * size.Z + size.Z * size.X);
+}
+
+FSelectionIndex::FSelectionIndex()
+	: BoundsMargin(10.f)
+	, Root(INDEX_NONE)
+	, FreeList(INDEX_NONE)
+{
+}
+
+FSelectionIndex::~FSelectionIndex()
+{
+	Reset();
+}
+
+bool FSelectionIndex::Add(UPrimitiveComponent* Component)
+{
+	RemoveFoundStaleLeaves();
+
+	const FComponentKey componentKey(Component);
+	if (!IsValid(Component) || LeafMap.Contains(componentKey)) return false;
+
+	const int32 leaf = AllocateNode();
+	FNode& node = Nodes[leaf];
+	node.Bounds = Component->Bounds.GetBox().ExpandBy(BoundsMargin);
+	node.Component = Component;
+	node.ComponentKey = componentKey;
+	node.LocalBounds = Component->CalcBounds(FTransform::Identity).GetBox();
+	node.TransformUpdatedHandle = Component->TransformUpdated.AddRaw(this, &FSelectionIndex::OnComponentTransformUpdated);
+
+	LeafMap.Add(componentKey, leaf);
+	InsertLeaf(leaf);
+	return true;
+}
+
+bool FSelectionIndex::Contains(const UPrimitiveComponent* Component) const
+{
+	return LeafMap.Contains(FComponentKey(Component));
+}
+
+bool FSelectionIndex::Remove(UPrimitiveComponent* Component)
+{
+	RemoveFoundStaleLeaves();
+
+	int32 leaf;
+	if (!LeafMap.RemoveAndCopyValue(FComponentKey(Component), leaf)) return false;
+
+	if (UPrimitiveComponent* component = Nodes[leaf].Component.Get())
+		component->TransformUpdated.Remove(Nodes[leaf].TransformUpdatedHandle);
+
+	RemoveLeaf(leaf);
+	FreeNode(leaf);
+	return true;
+}
+
+void FSelectionIndex::Reset()
+{
+	for (auto& leaf : LeafMap)
+	{
+		if (UPrimitiveComponent* component = Nodes[leaf.Value].Component.Get())
+			component->TransformUpdated.Remove(Nodes[leaf.Value].TransformUpdatedHandle);
+	}
+	LeafMap.Empty();
+	Nodes.Empty();
+	FoundStaleLeaves.Empty();
+	Root = INDEX_NONE;
+	FreeList = INDEX_NONE;
+}
+
+void FSelectionIndex::RemoveStaleLeaves()
+{
+	FoundStaleLeaves.Reset();
+	for (const auto& leaf : LeafMap)
+	{
+		if (!Nodes[leaf.Value].Component.IsValid())
+			FoundStaleLeaves.Add(leaf.Value);
+	}
+	RemoveFoundStaleLeaves();
+}
+
+void FSelectionIndex::RemoveFoundStaleLeaves()
+{
+	for (int32 leaf : FoundStaleLeaves)
+		RemoveStaleLeaf(leaf);
+	FoundStaleLeaves.Reset();
+}
+
+void FSelectionIndex::RemoveStaleLeaf(int32 Leaf)
+{
+	//the same Leaf can be found by several Queries, and might have been removed (or reused) since
+	FNode& node = Nodes[Leaf];
+	if (!node.IsLeaf() || node.Height != 0 || node.Component.IsValid()) return;
+
+	const int32* mappedLeaf = LeafMap.Find(node.ComponentKey);
+	if (!mappedLeaf || *mappedLeaf != Leaf) return;
+
+	//the Component (and its TransformUpdated delegate) is already gone, so only the Leaf is left to remove
+	LeafMap.Remove(node.ComponentKey);
+	RemoveLeaf(Leaf);
+	FreeNode(Leaf);
+}
+
+void FSelectionIndex::Update(UPrimitiveComponent* Component)
+{
+	RemoveFoundStaleLeaves();
+
+	const int32* leaf = LeafMap.Find(FComponentKey(Component));
+	if (!leaf) return;
+
+	const FBox bounds = Component->Bounds.GetBox();
+	if (Nodes[*leaf].Bounds.IsInside(bounds)) return;
+
+	INC_DWORD_STAT(STAT_SelectionIndexReinsertions);
+	RemoveLeaf(*leaf);
+	Nodes[*leaf].Bounds = bounds.ExpandBy(BoundsMargin);
+	InsertLeaf(*leaf);
+}
+
+void FSelectionIndex::OnComponentTransformUpdated(USceneComponent* UpdatedComponent
+	, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	//Bounds are already updated by the time TransformUpdated is broadcast
+	Update(Cast<UPrimitiveComponent>(UpdatedComponent));
+}
+
+void FSelectionIndex::Raycast(const FVector& RayStart, const FVector& RayEnd
+	, TArray<FSelectionIndexHit>& outHits, bool bFirstHitOnly) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SelectionIndexRaycast);
+
+	outHits.Reset();
+	if (Root == INDEX_NONE) return;
+
+	const FVector rayDirection = RayEnd - RayStart;
+	float maxTime = 1.f;
+
+	TArray<int32, TInlineAllocator<64>> stack;
+	stack.Add(Root);
+	while (stack.Num() > 0)
+	{
+		const FNode& node = Nodes[stack.Pop(false)];
+
+		float time;
+		if (!FTransformerMath::IntersectRayBox(RayStart, rayDirection, node.Bounds, time) || time > maxTime)
+			continue;
+
+		if (!node.IsLeaf())
+		{
+			stack.Add(node.Left);
+			stack.Add(node.Right);
+			continue;
+		}
+
+		UPrimitiveComponent* component = node.Component.Get();
+		if (!component)
+		{
+			FoundStaleLeaves.Add((int32)(&node - Nodes.GetData()));
+			continue;
+		}
+
+		//Ray Time is the same in Local Space, since the Component Transform is affine
+		const FTransform& componentTransform = component->GetComponentTransform();
+		const FVector localStart = componentTransform.InverseTransformPosition(RayStart);
+		const FVector localDirection = componentTransform.InverseTransformPosition(RayEnd) - localStart;
+		if (!FTransformerMath::IntersectRayBox(localStart, localDirection, node.LocalBounds, time) || time > maxTime)
+			continue;
+
+		if (bFirstHitOnly)
+		{
+			//anything farther than this hit can be skipped from now on
+			outHits.Reset();
+			maxTime = time;
+		}
+		outHits.Add({ component, time });
+	}
+
+	if (!bFirstHitOnly)
+	{
+		outHits.Sort([](const FSelectionIndexHit& a, const FSelectionIndexHit& b)
+		{
+			return a.Time < b.Time;
+		});
+	}
+}
+
+void FSelectionIndex::QueryConvexVolume(const FConvexVolume& Volume, TArray<UPrimitiveComponent*>& outComponents) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SelectionIndexVolumeQuery);
+
+	if (Root == INDEX_NONE) return;
+
+	TArray<int32, TInlineAllocator<64>> stack;
+	stack.Add(Root);
+	while (stack.Num() > 0)
+	{
+		const int32 nodeIndex = stack.Pop(false);
+		const FNode& node = Nodes[nodeIndex];
+
+		if (node.IsLeaf())
+		{
+			//Fat Bounds intersecting is not enough, test the actual Bounds
+			UPrimitiveComponent* component = node.Component.Get();
+			if (!component)
+				FoundStaleLeaves.Add(nodeIndex);
+			else if (Volume.IntersectBox(component->Bounds.Origin, component->Bounds.BoxExtent))
+				outComponents.Add(component);
+			continue;
+		}
+
+		bool bFullyContained;
+		if (!Volume.IntersectBox(node.Bounds.GetCenter(), node.Bounds.GetExtent(), bFullyContained))
+			continue;
+
+		if (bFullyContained)
+			GatherLeaves(nodeIndex, outComponents);
+		else
+		{
+			stack.Add(node.Left);
+			stack.Add(node.Right);
+		}
+	}
+}
+
+void FSelectionIndex::GatherLeaves(int32 NodeIndex, TArray<UPrimitiveComponent*>& outComponents) const
+{
+	TArray<int32, TInlineAllocator<64>> stack;
+	stack.Add(NodeIndex);
+	while (stack.Num() > 0)
+	{
+		const int32 nodeIndex = stack.Pop(false);
+		const FNode& node = Nodes[nodeIndex];
+		if (node.IsLeaf())
+		{
+			if (UPrimitiveComponent* component = node.Component.Get())
+				outComponents.Add(component);
+			else
+				FoundStaleLeaves.Add(nodeIndex);
+			continue;
+		}
+		stack.Add(node.Left);
+		stack.Add(node.Right);
+	}
+}
+
+int32 FSelectionIndex::GetHeight() const
+{
+	return (Root == INDEX_NONE) ? 0 : Nodes[Root].Height;
+}
+
+int32 FSelectionIndex::AllocateNode()
+{
+	int32 nodeIndex = FreeList;
+	if (nodeIndex != INDEX_NONE)
+		FreeList = Nodes[nodeIndex].Parent;
+	else
+		nodeIndex = Nodes.AddDefaulted();
+
+	FNode& node = Nodes[nodeIndex];
+	node.Bounds = FBox(ForceInit);
+	node.Parent = INDEX_NONE;
+	node.Left = INDEX_NONE;
+	node.Right = INDEX_NONE;
+	node.Height = 0;
+	node.Component.Reset();
+	node.ComponentKey = FComponentKey();
+	node.LocalBounds = FBox(ForceInit);
+	node.TransformUpdatedHandle.Reset();
+	return nodeIndex;
+}
+
+void FSelectionIndex::FreeNode(int32 NodeIndex)
+{
+	FNode& node = Nodes[NodeIndex];
+	node.Component.Reset();
+	node.ComponentKey = FComponentKey();
+	node.TransformUpdatedHandle.Reset();
+	node.Height = INDEX_NONE;
+	node.Parent = FreeList;
+	FreeList = NodeIndex;
+}
+
+void FSelectionIndex::InsertLeaf(int32 Leaf)
+{
+	if (Root == INDEX_NONE)
+	{
+		Root = Leaf;
+		Nodes[Leaf].Parent = INDEX_NONE;
+		return;
+	}
+
+	//Find the best Sibling going down the tree, choosing the child with the lowest Surface Area cost
+	const FBox leafBounds = Nodes[Leaf].Bounds;
+	int32 index = Root;
+	while (!Nodes[index].IsLeaf())
+	{
+		const FNode& node = Nodes[index];
+		const float area = GetSurfaceArea(node.Bounds);
+		const float combinedArea = GetSurfaceArea(node.Bounds + leafBounds);
+
+		//cost of making a new Parent for this Node and the Leaf
+		const float cost = 2.f * combinedArea;
+
+		//minimum cost of pushing the Leaf further down
+		const float inheritanceCost = 2.f * (combinedArea - area);
+
+		auto getDescendCost = [&](int32 Child)
+		{
+			const FNode& child = Nodes[Child];
+			const float childCombinedArea = GetSurfaceArea(child.Bounds + leafBounds);
+			return inheritanceCost + (child.IsLeaf() ? childCombinedArea : childCombinedArea - GetSurfaceArea(child.Bounds));
+		};
+
+		const float leftCost = getDescendCost(node.Left);
+		const float rightCost = getDescendCost(node.Right);
+
+		if (cost < leftCost && cost < rightCost) break;
+
+		index = (leftCost < rightCost) ? node.Left : node.Right;
+	}
+
+	const int32 sibling = index;
+	const int32 oldParent = Nodes[sibling].Parent;
+
+	//Nodes can be reallocated here, so no references are held across this call
+	const int32 newParent = AllocateNode();
+	Nodes[newParent].Parent = oldParent;
+	Nodes[newParent].Bounds = leafBounds + Nodes[sibling].Bounds;
+	Nodes[newParent].Height = Nodes[sibling].Height + 1;
+	Nodes[newParent].Left = sibling;
+	Nodes[newParent].Right = Leaf;
+	Nodes[sibling].Parent = newParent;
+	Nodes[Leaf].Parent = newParent;
+
+	if (oldParent == INDEX_NONE)
+		Root = newParent;
+	else if (Nodes[oldParent].Left == sibling)
+		Nodes[oldParent].Left = newParent;
+	else
+		Nodes[oldParent].Right = newParent;
+
+	//Walk back up fixing Heights and Bounds
+	index = Nodes[Leaf].Parent;
+	while (index != INDEX_NONE)
+	{
+		index = Balance(index);
+
+		FNode& node = Nodes[index];
+		node.Height = 1 + FMath::Max(Nodes[node.Left].Height, Nodes[node.Right].Height);
+		node.Bounds = Nodes[node.Left].Bounds + Nodes[node.Right].Bounds;
+
+		index = node.Parent;
+	}
+}
+
+void FSelectionIndex::RemoveLeaf(int32 Leaf)
+{
+	if (Leaf == Root)
+	{
+		Root = INDEX_NONE;
+		return;
+	}
+
+	const int32 parent = Nodes[Leaf].Parent;
+	const int32 grandParent = Nodes[parent].Parent;
+	const int32 sibling = (Nodes[parent].Left == Leaf) ? Nodes[parent].Right : Nodes[parent].Left;
+
+	//the Sibling takes the place of the Parent
+	Nodes[sibling].Parent = grandParent;
+	FreeNode(parent);
+
+	if (grandParent == INDEX_NONE)
+	{
+		Root = sibling;
+		return;
+	}
+
+	if (Nodes[grandParent].Left == parent)
+		Nodes[grandParent].Left = sibling;
+	else
+		Nodes[grandParent].Right = sibling;
+
+	int32 index = grandParent;
+	while (index != INDEX_NONE)
+	{
+		index = Balance(index);
+
+		FNode& node = Nodes[index];
+		node.Height = 1 + FMath::Max(Nodes[node.Left].Height, Nodes[node.Right].Height);
+		node.Bounds = Nodes[node.Left].Bounds + Nodes[node.Right].Bounds;
+
+		index = node.Parent;
+	}
+}
+
+int32 FSelectionIndex::Balance(int32 NodeIndex)
+{
+	const int32 iA = NodeIndex;
+	FNode& A = Nodes[iA];
+	if (A.IsLeaf() || A.Height < 2) return iA;
+
+	const int32 iB = A.Left;
+	const int32 iC = A.Right;
+	FNode& B = Nodes[iB];
+	FNode& C = Nodes[iC];
+
+	const int32 balance = C.Height - B.Height;
+
+	//Only one of the children can go up, taking A as its child
+	auto replaceInParent = [&](int32 NewChild)
+	{
+		FNode& newChild = Nodes[NewChild];
+		newChild.Parent = A.Parent;
+		A.Parent = NewChild;
+
+		if (newChild.Parent == INDEX_NONE)
+			Root = NewChild;
+		else if (Nodes[newChild.Parent].Left == iA)
+			Nodes[newChild.Parent].Left = NewChild;
+		else
+			Nodes[newChild.Parent].Right = NewChild;
+	};
+
+	//Rotate C up
+	if (balance > 1)
+	{
+		const int32 iF = C.Left;
+		const int32 iG = C.Right;
+		FNode& F = Nodes[iF];
+		FNode& G = Nodes[iG];
+
+		C.Left = iA;
+		replaceInParent(iC);
+
+		//the taller grandchild stays with C
+		const bool bKeepF = F.Height > G.Height;
+		const int32 iKept = bKeepF ? iF : iG;
+		const int32 iMoved = bKeepF ? iG : iF;
+
+		C.Right = iKept;
+		A.Right = iMoved;
+		Nodes[iMoved].Parent = iA;
+
+		A.Bounds = B.Bounds + Nodes[iMoved].Bounds;
+		C.Bounds = A.Bounds + Nodes[iKept].Bounds;
+		A.Height = 1 + FMath::Max(B.Height, Nodes[iMoved].Height);
+		C.Height = 1 + FMath::Max(A.Height, Nodes[iKept].Height);
+		return iC;
+	}
+
+	//Rotate B up
+	if (balance < -1)
+	{
+		const int32 iD = B.Left;
+		const int32 iE = B.Right;
+		FNode& D = Nodes[iD];
+		FNode& E = Nodes[iE];
+
+		B.Left = iA;
+		replaceInParent(iB);
+
+		const bool bKeepD = D.Height > E.Height;
+		const int32 iKept = bKeepD ? iD : iE;
+		const int32 iMoved = bKeepD ? iE : iD;
+
+		B.Right = iKept;
+		A.Left = iMoved;
+		Nodes[iMoved].Parent = iA;
+
+		A.Bounds = C.Bounds + Nodes[iMoved].Bounds;
+		B.Bounds = A.Bounds + Nodes[iKept].Bounds;
+		A.Height = 1 + FMath::Max(C.Height, Nodes[iMoved].Height);
+		B.Height = 1 + FMath::Max(A.Height, Nodes[iKept].Height);
+		return iB;
+	}
+
+	return iA;
+}
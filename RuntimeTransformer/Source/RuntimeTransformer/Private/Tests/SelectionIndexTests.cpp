@@ -0,0 +1,323 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "SelectionIndex.h"
+#include "TransformerMath.h"
+#include "TransformerTestHelpers.h"
+#include "Components/BoxComponent.h"
+#include "ConvexVolume.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SelectionIndexTests
+{
+	static const float BoxExtent = 40.f;
+
+	//Boxes laid out in a dense grid. Rooted, as nothing else references them
+	static void SpawnBoxes(int32 Count, TArray<UBoxComponent*>& outBoxes)
+	{
+		const int32 side = FMath::CeilToInt(FMath::Pow((float)Count, 1.f / 3.f));
+		for (int32 i = 0; i < Count; ++i)
+		{
+			UBoxComponent* box = NewObject<UBoxComponent>(GetTransientPackage());
+			box->AddToRoot();
+			box->SetBoxExtent(FVector(BoxExtent), false);
+			box->SetWorldLocation(FVector(i % side, (i / side) % side, i / (side * side)) * BoxExtent * 3.f);
+			outBoxes.Add(box);
+		}
+	}
+
+	static void DestroyBoxes(TArray<UBoxComponent*>& Boxes)
+	{
+		for (UBoxComponent* box : Boxes)
+		{
+			box->RemoveFromRoot();
+			box->MarkPendingKill();
+		}
+		Boxes.Reset();
+	}
+
+	//What the Index should find: every Box (not rotated, so their Local Bounds are their World Bounds) the Segment hits
+	static void BruteForceRaycast(const TArray<UBoxComponent*>& Boxes, const FVector& RayStart, const FVector& RayEnd
+		, TArray<FSelectionIndexHit>& outHits)
+	{
+		outHits.Reset();
+		for (UBoxComponent* box : Boxes)
+		{
+			float time;
+			if (FTransformerMath::IntersectRayBox(RayStart, RayEnd - RayStart, box->Bounds.GetBox(), time))
+				outHits.Add({ box, time });
+		}
+		outHits.Sort([](const FSelectionIndexHit& a, const FSelectionIndexHit& b) { return a.Time < b.Time; });
+	}
+
+	static bool HaveSameComponents(const TArray<FSelectionIndexHit>& A, const TArray<FSelectionIndexHit>& B)
+	{
+		if (A.Num() != B.Num()) return false;
+		TSet<UPrimitiveComponent*> components;
+		for (const FSelectionIndexHit& hit : A)
+			components.Add(hit.Component);
+		for (const FSelectionIndexHit& hit : B)
+		{
+			if (!components.Contains(hit.Component))
+				return false;
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionIndexTest, "RuntimeTransformer.SelectionIndex.AddRaycastRemove"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSelectionIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace SelectionIndexTests;
+
+	TArray<UBoxComponent*> boxes;
+	SpawnBoxes(1000, boxes);
+
+	FSelectionIndex index;
+	for (UBoxComponent* box : boxes)
+		TestTrue(TEXT("Box is added"), index.Add(box));
+	TestFalse(TEXT("Box is not added twice"), index.Add(boxes[0]));
+	TestEqual(TEXT("Num"), index.Num(), boxes.Num());
+	//a balanced tree of N Leaves is about Log2(N) high
+	TestTrue(TEXT("Tree is balanced"), index.GetHeight() <= 2 * (int32)FMath::CeilLogTwo((uint32)boxes.Num()) + 2);
+
+	FRandomStream stream(0x1D3);
+	const FBox sceneBounds = FBox(FVector(-BoxExtent), boxes.Last()->GetComponentLocation() + BoxExtent).ExpandBy(200.f);
+	TArray<FSelectionIndexHit> indexHits, expectedHits;
+	auto TestRaycasts = [&](const TCHAR* What)
+	{
+		for (int32 i = 0; i < 200; ++i)
+		{
+			const FVector rayStart = stream.RandPointInBox(sceneBounds);
+			const FVector rayEnd = stream.RandPointInBox(sceneBounds);
+			index.Raycast(rayStart, rayEnd, indexHits);
+			BruteForceRaycast(boxes, rayStart, rayEnd, expectedHits);
+			if (!HaveSameComponents(indexHits, expectedHits))
+			{
+				AddError(FString::Printf(TEXT("%s: %d hits, %d expected"), What, indexHits.Num(), expectedHits.Num()));
+				return;
+			}
+
+			index.Raycast(rayStart, rayEnd, indexHits, true);
+			if (expectedHits.Num() > 0 && (indexHits.Num() != 1 || !FMath::IsNearlyEqual(indexHits[0].Time, expectedHits[0].Time, 1.e-4f)))
+			{
+				AddError(FString::Printf(TEXT("%s: wrong first hit"), What));
+				return;
+			}
+		}
+	};
+	TestRaycasts(TEXT("Added"));
+
+	//every other Box is removed
+	TArray<UBoxComponent*> removedBoxes;
+	for (int32 i = boxes.Num() - 1; i >= 0; i -= 2)
+	{
+		TestTrue(TEXT("Box is removed"), index.Remove(boxes[i]));
+		removedBoxes.Add(boxes[i]);
+		boxes.RemoveAt(i);
+	}
+	TestFalse(TEXT("Box is not removed twice"), index.Remove(removedBoxes[0]));
+	TestEqual(TEXT("Num after Remove"), index.Num(), boxes.Num());
+	TestRaycasts(TEXT("Removed"));
+
+	//the Index follows the Boxes that move
+	for (int32 i = 0; i < boxes.Num(); i += 3)
+		boxes[i]->SetWorldLocation(stream.RandPointInBox(sceneBounds));
+	TestRaycasts(TEXT("Moved"));
+
+	//deleted Boxes are skipped by the Queries and do not keep a new Object (maybe at the same address) out of the Index
+	TArray<UBoxComponent*> deletedBoxes(boxes.GetData(), boxes.Num() / 2);
+	boxes.RemoveAt(0, deletedBoxes.Num());
+	DestroyBoxes(deletedBoxes);
+	DestroyBoxes(removedBoxes);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	TestRaycasts(TEXT("Deleted"));
+
+	TArray<UBoxComponent*> newBoxes;
+	SpawnBoxes(100, newBoxes);
+	for (UBoxComponent* box : newBoxes)
+		TestTrue(TEXT("New Box is added"), index.Add(box));
+	boxes.Append(newBoxes);
+	TestRaycasts(TEXT("Added after the delete"));
+
+	index.RemoveStaleLeaves();
+	TestEqual(TEXT("Num after the Stale Leaves are removed"), index.Num(), boxes.Num());
+	TestRaycasts(TEXT("Stale Leaves removed"));
+
+	index.Reset();
+	TestEqual(TEXT("Num after Reset"), index.Num(), 0);
+	DestroyBoxes(boxes);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionIndexOrthographicFrustumTest, "RuntimeTransformer.SelectionIndex.OrthographicFrustum"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSelectionIndexOrthographicFrustumTest::RunTest(const FString& Parameters)
+{
+	using namespace SelectionIndexTests;
+
+	//a row of Boxes along X, in front of and behind a Camera at the Origin looking down X
+	TArray<UBoxComponent*> boxes;
+	SpawnBoxes(21, boxes);
+	for (int32 i = 0; i < boxes.Num(); ++i)
+		boxes[i]->SetWorldLocation(FVector((i - 10) * BoxExtent * 3.f, 0.f, 0.f));
+
+	FSelectionIndex index;
+	for (UBoxComponent* box : boxes)
+		index.Add(box);
+
+	//what ATransformerPawn::GetMarqueeFrustumPlanes builds for an Orthographic View: the sides are parallel to the view
+	const float halfSize = BoxExtent * 2.f;
+	const float traceDistance = BoxExtent * 3.f * 5.f;
+	TArray<FPlane> sidePlanes = { FPlane(FVector(0.f, halfSize, 0.f), FVector::RightVector)
+		, FPlane(FVector(0.f, -halfSize, 0.f), FVector::LeftVector)
+		, FPlane(FVector(0.f, 0.f, halfSize), FVector::UpVector)
+		, FPlane(FVector(0.f, 0.f, -halfSize), FVector::DownVector)
+		, FPlane(FVector(traceDistance, 0.f, 0.f), FVector::ForwardVector) };
+
+	FConvexVolume withoutNearPlane(sidePlanes);
+	sidePlanes.Add(FPlane(FVector::ZeroVector, FVector::BackwardVector));
+	FConvexVolume withNearPlane(sidePlanes);
+
+	TArray<UPrimitiveComponent*> found;
+	index.QueryConvexVolume(withoutNearPlane, found);
+	TestTrue(TEXT("Without a Near Plane, Boxes behind the Camera are found"), found.ContainsByPredicate(
+		[](UPrimitiveComponent* Component) { return Component->GetComponentLocation().X < -BoxExtent; }));
+
+	found.Reset();
+	index.QueryConvexVolume(withNearPlane, found);
+	int32 expectedCount = 0;
+	for (UBoxComponent* box : boxes)
+	{
+		const float x = box->GetComponentLocation().X;
+		const bool bExpected = x + BoxExtent >= 0.f && x - BoxExtent <= traceDistance;
+		expectedCount += bExpected ? 1 : 0;
+		if (found.Contains(box) != bExpected)
+			AddError(FString::Printf(TEXT("Box at %.0f is %s"), x, bExpected ? TEXT("not found") : TEXT("found")));
+	}
+	TestEqual(TEXT("Boxes found"), found.Num(), expectedCount);
+
+	index.Reset();
+	DestroyBoxes(boxes);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionIndexRaycastTimingTest, "RuntimeTransformer.SelectionIndex.DenseRaycastTiming"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSelectionIndexRaycastTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace SelectionIndexTests;
+
+	//Only the Index is timed here: the same rays against the Physics Scene need a World (stat RuntimeTransformer in game)
+	TArray<UBoxComponent*> boxes;
+	SpawnBoxes(10000, boxes);
+
+	FSelectionIndex index;
+	for (UBoxComponent* box : boxes)
+		index.Add(box);
+
+	FRandomStream stream(0xB0C5);
+	const FBox sceneBounds = FBox(FVector(-BoxExtent), boxes.Last()->GetComponentLocation() + BoxExtent);
+	const int32 rayCount = 1000;
+	TArray<FVector> rayPoints;
+	for (int32 i = 0; i < rayCount * 2; ++i)
+		rayPoints.Add(stream.RandPointInBox(sceneBounds));
+
+	TArray<FSelectionIndexHit> hits;
+	double startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < rayCount; ++i)
+		index.Raycast(rayPoints[i * 2], rayPoints[i * 2 + 1], hits, true);
+	const double firstHitTime = FPlatformTime::Seconds() - startTime;
+
+	startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < rayCount; ++i)
+		index.Raycast(rayPoints[i * 2], rayPoints[i * 2 + 1], hits);
+	const double allHitsTime = FPlatformTime::Seconds() - startTime;
+
+	startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < rayCount; ++i)
+		BruteForceRaycast(boxes, rayPoints[i * 2], rayPoints[i * 2 + 1], hits);
+	const double bruteForceTime = FPlatformTime::Seconds() - startTime;
+
+	AddInfo(FString::Printf(TEXT("%d Boxes, %d Rays (us per Ray): first hit %.2f, all hits %.2f, brute force %.2f")
+		, boxes.Num(), rayCount, firstHitTime * 1.e6 / rayCount, allHitsTime * 1.e6 / rayCount, bruteForceTime * 1.e6 / rayCount));
+
+	index.Reset();
+	DestroyBoxes(boxes);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionIndexFrustumTimingTest, "RuntimeTransformer.SelectionIndex.FrustumQueryTiming"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSelectionIndexFrustumTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace SelectionIndexTests;
+	using namespace TransformerTestHelpers;
+
+	//Only the Index is timed here (@see RuntimeTransformer.Pawn.MarqueeTiming for the whole SelectInFrustum)
+	TArray<UBoxComponent*> boxes;
+	SpawnBoxes(50000, boxes);
+
+	FSelectionIndex index;
+	for (UBoxComponent* box : boxes)
+		index.Add(box);
+
+	//Marquees from a few Boxes wide up to the whole Scene
+	FRandomStream stream(0xF2);
+	const FBox sceneBounds = FBox(FVector(-BoxExtent), boxes.Last()->GetComponentLocation() + BoxExtent);
+	const float fractions[] = { 0.02f, 0.1f, 0.5f, 1.f };
+	const int32 queryCount = 20;
+	TArray<UPrimitiveComponent*> found;
+	for (float fraction : fractions)
+	{
+		TArray<FConvexVolume> volumes;
+		TArray<FBox> volumeBoxes;
+		for (int32 i = 0; i < queryCount; ++i)
+		{
+			const FVector extent = sceneBounds.GetExtent() * fraction;
+			const FVector center = stream.RandPointInBox(FBox(sceneBounds.Min + extent, sceneBounds.Max - extent + KINDA_SMALL_NUMBER));
+			volumeBoxes.Add(FBox(center - extent, center + extent));
+			volumes.Add(FConvexVolume(GetBoxPlanes(volumeBoxes.Last())));
+		}
+
+		int32 foundCount = 0;
+		double startTime = FPlatformTime::Seconds();
+		for (const FConvexVolume& volume : volumes)
+		{
+			found.Reset();
+			index.QueryConvexVolume(volume, found);
+			foundCount += found.Num();
+		}
+		const double indexTime = FPlatformTime::Seconds() - startTime;
+
+		//what the Marquee did before the Index: test the Bounds of every Component
+		int32 expectedCount = 0;
+		startTime = FPlatformTime::Seconds();
+		for (const FConvexVolume& volume : volumes)
+		{
+			for (UBoxComponent* box : boxes)
+				expectedCount += volume.IntersectBox(box->Bounds.Origin, box->Bounds.BoxExtent) ? 1 : 0;
+		}
+		const double bruteForceTime = FPlatformTime::Seconds() - startTime;
+
+		TestEqual(FString::Printf(TEXT("Boxes found in %.0f%% of the Scene"), fraction * 100.f), foundCount, expectedCount);
+		AddInfo(FString::Printf(TEXT("%d Boxes, Marquee over %.0f%% of the Scene (%d found per Query): Index %.3f ms, brute force %.3f ms per Query")
+			, boxes.Num(), fraction * 100.f, foundCount / queryCount, indexTime * 1000.0 / queryCount, bruteForceTime * 1000.0 / queryCount));
+	}
+
+	index.Reset();
+	DestroyBoxes(boxes);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
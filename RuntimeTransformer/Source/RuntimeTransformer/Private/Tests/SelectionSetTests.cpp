@@ -0,0 +1,116 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "SelectionSet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SelectionSetTests
+{
+	//Selects Count elements, toggles a random half of them (the way a Marquee would), then deselects everything
+	static double TimeSelection(int32 Count, FRandomStream& Stream)
+	{
+		TArray<int32> toggled;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			if (Stream.FRand() < 0.5f)
+				toggled.Add(i);
+		}
+
+		const double startTime = FPlatformTime::Seconds();
+		TSelectionSet<int32> selection;
+		for (int32 i = 0; i < Count; ++i)
+			selection.Add(i);
+		for (int32 element : toggled)
+		{
+			if (!selection.Remove(element))
+				selection.Add(element);
+		}
+		for (int32 element : selection.GetArray())
+			check(selection.Contains(element));
+		for (int32 i = 0; i < Count; ++i)
+			selection.Remove(i);
+		return FPlatformTime::Seconds() - startTime;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionSetTest, "RuntimeTransformer.SelectionSet.AddRemoveOrder"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSelectionSetTest::RunTest(const FString& Parameters)
+{
+	//what the Selection used to be: a plain Array, kept in the order the elements were added
+	TArray<int32> expected;
+	TSelectionSet<int32> selection;
+
+	FRandomStream stream(0x5E1);
+	for (int32 step = 0; step < 20000; ++step)
+	{
+		const int32 element = stream.RandRange(0, 999);
+		const float action = stream.FRand();
+		if (action < 0.55f)
+		{
+			TestTrue(TEXT("Add"), selection.Add(element) == !expected.Contains(element));
+			expected.AddUnique(element);
+		}
+		else if (action < 0.999f)
+		{
+			TestTrue(TEXT("Remove"), selection.Remove(element) == (expected.Remove(element) > 0));
+		}
+		else
+		{
+			selection.Empty();
+			expected.Reset();
+		}
+
+		if (!TestEqual(TEXT("Num"), selection.Num(), expected.Num()))
+			return false;
+
+		if (expected.Num() > 0 && (selection.First() != expected[0] || selection.Last() != expected.Last()))
+		{
+			AddError(FString::Printf(TEXT("Step %d: First/Last are %d/%d, expected %d/%d"), step
+				, selection.First(), selection.Last(), expected[0], expected.Last()));
+			return false;
+		}
+
+		//reading the Array compacts the Set, so it is only read now and then to also cover the lazy compaction
+		if ((step % 97) == 0 && selection.GetArray() != expected)
+		{
+			AddError(FString::Printf(TEXT("Step %d: the Array is not in the order the elements were added"), step));
+			return false;
+		}
+	}
+
+	for (int32 element = 0; element < 1000; ++element)
+		TestTrue(TEXT("Contains"), selection.Contains(element) == expected.Contains(element));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionSetScalingTest, "RuntimeTransformer.SelectionSet.Scaling"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSelectionSetScalingTest::RunTest(const FString& Parameters)
+{
+	using namespace SelectionSetTests;
+
+	//best of a few runs, to not be thrown off by the rest of the machine
+	FRandomStream stream(0x10C);
+	double smallTime = MAX_dbl, largeTime = MAX_dbl;
+	for (int32 run = 0; run < 5; ++run)
+	{
+		smallTime = FMath::Min(smallTime, TimeSelection(1000, stream));
+		largeTime = FMath::Min(largeTime, TimeSelection(10000, stream));
+	}
+
+	const double ratio = largeTime / FMath::Max(smallTime, 1.e-9);
+	AddInfo(FString::Printf(TEXT("1k Selection: %.3f ms, 10k Selection: %.3f ms (x%.1f)")
+		, smallTime * 1000.0, largeTime * 1000.0, ratio));
+
+	//10 times the elements is about 10 times the work. A linear search per operation would be about 100 times
+	TestTrue(TEXT("10k Selection scales linearly"), ratio < 40.0);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,63 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TransformerMath.h"
+#include "TransformerTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerApplyDeltaTransformTest, "RuntimeTransformer.Math.ApplyDeltaTransform"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerApplyDeltaTransformTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerTestHelpers;
+
+	FRandomStream stream(0xDE17A);
+
+	for (int32 iteration = 0; iteration < 64; ++iteration)
+	{
+		//not a multiple of 4, so that the scalar remainder is covered as well
+		const int32 count = stream.RandRange(1, 259);
+		FTransformSoA startTransforms;
+		for (int32 i = 0; i < count; ++i)
+			startTransforms.Add(FTransform(RandomQuat(stream), RandomVector(stream, 10000.f), RandomVector(stream, 5.f)));
+
+		FTransform deltaTransform(RandomQuat(stream), RandomVector(stream, 1000.f), RandomVector(stream, 1.f));
+		const FVector pivot = RandomVector(stream, 10000.f);
+		const bool bRotateOnLocalAxis = (iteration & 1) != 0;
+
+		//any range, as the Drag Session evaluates in blocks
+		const int32 beginIndex = stream.RandRange(0, count - 1);
+		const int32 endIndex = stream.RandRange(beginIndex + 1, count);
+
+		FTransformSoA kernelTransforms, scalarTransforms;
+		kernelTransforms.SetNum(count);
+		scalarTransforms.SetNum(count);
+		FTransformerMath::ApplyDeltaTransform(startTransforms, kernelTransforms, beginIndex, endIndex
+			, deltaTransform, pivot, bRotateOnLocalAxis);
+		FTransformerMath::ApplyDeltaTransform_Scalar(startTransforms, scalarTransforms, beginIndex, endIndex
+			, deltaTransform, pivot, bRotateOnLocalAxis);
+
+		for (int32 i = beginIndex; i < endIndex; ++i)
+		{
+			const FTransform kernelTransform = kernelTransforms.GetTransform(i);
+			const FTransform scalarTransform = scalarTransforms.GetTransform(i);
+
+			//Locations are up to ~10^4, so the float error of the different operation order grows with them
+			if (!kernelTransform.GetLocation().Equals(scalarTransform.GetLocation(), 0.05f)
+				|| !kernelTransform.GetRotation().Equals(scalarTransform.GetRotation(), 1.e-4f)
+				|| !kernelTransform.GetScale3D().Equals(scalarTransform.GetScale3D(), 1.e-3f))
+			{
+				AddError(FString::Printf(TEXT("Transform %d of [%d, %d): kernel %s, scalar %s"), i, beginIndex, endIndex
+					, *kernelTransform.ToString(), *scalarTransform.ToString()));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
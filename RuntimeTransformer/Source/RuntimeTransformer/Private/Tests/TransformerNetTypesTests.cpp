@@ -0,0 +1,279 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TransformerNetTypes.h"
+#include "TransformerTestHelpers.h"
+#include "UObject/CoreNet.h"
+#include "UObject/UnrealType.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TransformerNetTypesTests
+{
+	using namespace TransformerTestHelpers;
+
+	//nearly tied largest components are the hardest case for the Quaternion compression
+	static FQuat RandomQuatWithTies(FRandomStream& Stream)
+	{
+		FQuat quat = RandomQuat(Stream);
+		if (Stream.FRand() < 0.25f)
+			quat.Y = quat.X * (1.f + Stream.FRandRange(-1.e-4f, 1.e-4f));
+		return quat.GetNormalized();
+	}
+
+	static FTransform RandomTransform(FRandomStream& Stream)
+	{
+		const FVector location = RandomVector(Stream, 100000.f);
+		const FVector scale = (Stream.FRand() < 0.5f) ? FVector::OneVector
+			: FVector(Stream.FRandRange(0.1f, 10.f), Stream.FRandRange(0.1f, 10.f), Stream.FRandRange(0.1f, 10.f));
+		return FTransform(RandomQuatWithTies(Stream), location, scale);
+	}
+
+	static bool IsBitIdentical(const FTransform& A, const FTransform& B)
+	{
+		const FQuat rotationA = A.GetRotation(), rotationB = B.GetRotation();
+		const FVector locationA = A.GetLocation(), locationB = B.GetLocation();
+		const FVector scaleA = A.GetScale3D(), scaleB = B.GetScale3D();
+		return FMemory::Memcmp(&rotationA, &rotationB, sizeof(FQuat)) == 0
+			&& FMemory::Memcmp(&locationA, &locationB, sizeof(FVector)) == 0
+			&& FMemory::Memcmp(&scaleA, &scaleB, sizeof(FVector)) == 0;
+	}
+
+	/**
+	 * Sends a Net Type through the same Archives the Net Driver uses.
+	 * There is no Package Map, so Components are sent as nullptr (and arrive as nullptr)
+	 */
+	template<typename NetType>
+	static bool RoundTrip(const NetType& Sent, NetType& OutReceived)
+	{
+		NetType sent = Sent;
+		FNetBitWriter writer(nullptr, 8192);
+		bool bSuccess = true;
+		sent.NetSerialize(writer, nullptr, bSuccess);
+		if (!bSuccess || writer.IsError())
+			return false;
+
+		FNetBitReader reader(nullptr, writer.GetData(), writer.GetNumBits());
+		OutReceived.NetSerialize(reader, nullptr, bSuccess);
+		return bSuccess && !reader.IsError();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerQuatSerializeTest, "RuntimeTransformer.NetTypes.SerializeQuat"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerQuatSerializeTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerNetTypesTests;
+
+	FRandomStream stream(0x5EED);
+	for (int32 i = 0; i < 10000; ++i)
+	{
+		const FQuat original = RandomQuatWithTies(stream);
+
+		FQuat received = original;
+		{
+			FNetBitWriter writer(nullptr, 64);
+			FTransformerNetQuantize::SerializeQuat(received, writer);
+			FNetBitReader reader(nullptr, writer.GetData(), writer.GetNumBits());
+			FTransformerNetQuantize::SerializeQuat(received, reader);
+		}
+
+		//relayed: serialized again from what was received
+		FQuat relayed = received;
+		{
+			FNetBitWriter writer(nullptr, 64);
+			FTransformerNetQuantize::SerializeQuat(relayed, writer);
+			FNetBitReader reader(nullptr, writer.GetData(), writer.GetNumBits());
+			FTransformerNetQuantize::SerializeQuat(relayed, reader);
+		}
+
+		if (!received.Equals(original, 1.e-3f) && !received.Equals(original * -1.f, 1.e-3f))
+		{
+			AddError(FString::Printf(TEXT("Quat %s was received as %s"), *original.ToString(), *received.ToString()));
+			return false;
+		}
+
+		if (FMemory::Memcmp(&received, &relayed, sizeof(FQuat)) != 0)
+		{
+			AddError(FString::Printf(TEXT("Quat %s was relayed as %s"), *received.ToString(), *relayed.ToString()));
+			return false;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerTransformCommitTest, "RuntimeTransformer.NetTypes.TransformCommit"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerTransformCommitTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerNetTypesTests;
+
+	FRandomStream stream(0xC0331);
+	for (int32 iteration = 0; iteration < 32; ++iteration)
+	{
+		FTransformerTransformCommit commit;
+		commit.DragId = (uint8)stream.RandRange(0, 255);
+		commit.bStreamed = stream.FRand() < 0.5f;
+		commit.ChunkIndex = (uint16)stream.RandRange(0, 64);
+
+		const int32 count = stream.RandRange(1, 256);
+		for (int32 i = 0; i < count; ++i)
+		{
+			const int32 instanceIndex = (stream.FRand() < 0.5f) ? INDEX_NONE : stream.RandRange(0, 100000);
+			commit.Transforms.Emplace(nullptr, instanceIndex, RandomTransform(stream));
+		}
+
+		//what the Dragging Pawn applies
+		FTransformerTransformCommit quantized = commit;
+		quantized.Quantize();
+
+		//what the Server gets, and what the Server relays to everyone else
+		FTransformerTransformCommit received, relayed;
+		if (!TestTrue(TEXT("Commit is received"), RoundTrip(quantized, received))
+			|| !TestTrue(TEXT("Commit is relayed"), RoundTrip(received, relayed)))
+			return false;
+
+		TestTrue(TEXT("DragId"), relayed.DragId == commit.DragId);
+		TestTrue(TEXT("bStreamed"), relayed.bStreamed == commit.bStreamed);
+		TestTrue(TEXT("ChunkIndex"), relayed.ChunkIndex == commit.ChunkIndex);
+		if (!TestEqual(TEXT("Transform count"), relayed.Transforms.Num(), commit.Transforms.Num()))
+			return false;
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			TestEqual(TEXT("InstanceIndex"), relayed.Transforms[i].InstanceIndex, commit.Transforms[i].InstanceIndex);
+
+			const FTransform& original = commit.Transforms[i].Transform;
+			if (!original.Equals(quantized.Transforms[i].Transform, 0.1f))
+			{
+				AddError(FString::Printf(TEXT("Transform %s was quantized as %s"), *original.ToString()
+					, *quantized.Transforms[i].Transform.ToString()));
+				return false;
+			}
+
+			if (!IsBitIdentical(quantized.Transforms[i].Transform, received.Transforms[i].Transform)
+				|| !IsBitIdentical(quantized.Transforms[i].Transform, relayed.Transforms[i].Transform))
+			{
+				AddError(FString::Printf(TEXT("Transform %s does not converge: %s received, %s relayed")
+					, *quantized.Transforms[i].Transform.ToString(), *received.Transforms[i].Transform.ToString()
+					, *relayed.Transforms[i].Transform.ToString()));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerSelectionDeltaTest, "RuntimeTransformer.NetTypes.SelectionDelta"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerSelectionDeltaTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerNetTypesTests;
+
+	FRandomStream stream(0xDE17);
+	for (int32 iteration = 0; iteration < 32; ++iteration)
+	{
+		FTransformerSelectionDelta delta;
+		delta.BaseSequence = (uint32)stream.RandRange(0, MAX_int32);
+		delta.Sequence = delta.BaseSequence + 1;
+		delta.SelectedCount = (stream.FRand() < 0.25f) ? INDEX_NONE : stream.RandRange(0, 100000);
+		delta.Added.SetNumZeroed(stream.RandRange(0, 600));
+		delta.Removed.SetNumZeroed(stream.RandRange(0, 600));
+
+		FTransformerSelectionDelta received;
+		if (!TestTrue(TEXT("Delta is received"), RoundTrip(delta, received)))
+			return false;
+
+		TestTrue(TEXT("BaseSequence"), received.BaseSequence == delta.BaseSequence);
+		TestTrue(TEXT("Sequence"), received.Sequence == delta.Sequence);
+		TestEqual(TEXT("SelectedCount"), received.SelectedCount, delta.SelectedCount);
+		TestEqual(TEXT("Added"), received.Added.Num(), delta.Added.Num());
+		TestEqual(TEXT("Removed"), received.Removed.Num(), delta.Removed.Num());
+
+		//nullptr Components have no Network GUID, so they are not waited for
+		TestEqual(TEXT("UnresolvedAdded"), received.UnresolvedAdded.Num(), 0);
+		TestEqual(TEXT("UnresolvedRemoved"), received.UnresolvedRemoved.Num(), 0);
+	}
+
+	//a Receiver never allocates more than a Delta can carry
+	FTransformerSelectionDelta oversized, received;
+	oversized.Added.SetNumZeroed(FTransformerSelectionDelta::MaxComponents + 1);
+	TestFalse(TEXT("Oversized Delta is rejected"), RoundTrip(oversized, received));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerSelectionSnapshotTest, "RuntimeTransformer.NetTypes.SelectionSnapshot"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerSelectionSnapshotTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerNetTypesTests;
+
+	FRandomStream stream(0x54A9);
+	for (int32 iteration = 0; iteration < 32; ++iteration)
+	{
+		FTransformerSelectionSnapshot snapshot;
+		snapshot.Sequence = (uint32)stream.RandRange(0, MAX_int32);
+		snapshot.ChunkCount = stream.RandRange(1, 64);
+		snapshot.ChunkIndex = stream.RandRange(0, snapshot.ChunkCount - 1);
+		snapshot.Components.SetNumZeroed(stream.RandRange(0, 1024));
+
+		FTransformerSelectionSnapshot received;
+		if (!TestTrue(TEXT("Snapshot is received"), RoundTrip(snapshot, received)))
+			return false;
+
+		TestTrue(TEXT("Sequence"), received.Sequence == snapshot.Sequence);
+		TestEqual(TEXT("ChunkIndex"), received.ChunkIndex, snapshot.ChunkIndex);
+		TestEqual(TEXT("ChunkCount"), received.ChunkCount, snapshot.ChunkCount);
+		TestEqual(TEXT("Components"), received.Components.Num(), snapshot.Components.Num());
+		TestEqual(TEXT("UnresolvedComponents"), received.UnresolvedComponents.Num(), 0);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerModeStateTest, "RuntimeTransformer.NetTypes.ModeState"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerModeStateTest::RunTest(const FString& Parameters)
+{
+	FTransformerModeState sent;
+	sent.SpaceType = ESpaceType::ST_Local;
+	sent.TransformationType = ETransformationType::TT_Scale;
+	sent.Domain = ETransformationDomain::TD_XY_Plane;
+	sent.bComponentBased = true;
+	sent.bRotateOnLocalAxis = true;
+
+	//each Member is sent the way the Net Driver sends a changed Property, so these are the Payload bits of a change
+	// without the Property Handle. This is only reported: it is not compared against the Multicast RPCs it replaced
+	// (their Bunches, Headers included, would need a live Connection to measure)
+	FNetBitWriter writer(nullptr, 64);
+	FString memberBits;
+	for (TFieldIterator<FProperty> it(FTransformerModeState::StaticStruct()); it; ++it)
+	{
+		const int64 startBits = writer.GetNumBits();
+		it->NetSerializeItem(writer, nullptr, it->ContainerPtrToValuePtr<void>(&sent));
+		const int64 bits = writer.GetNumBits() - startBits;
+		memberBits += FString::Printf(TEXT(" %s %lld,"), *it->GetName(), bits);
+	}
+	AddInfo(FString::Printf(TEXT("Mode State Payload bits:%s %lld in total (what a late joiner gets)"), *memberBits, writer.GetNumBits()));
+
+	FTransformerModeState received;
+	FNetBitReader reader(nullptr, writer.GetData(), writer.GetNumBits());
+	for (TFieldIterator<FProperty> it(FTransformerModeState::StaticStruct()); it; ++it)
+		it->NetSerializeItem(reader, nullptr, it->ContainerPtrToValuePtr<void>(&received));
+
+	TestFalse(TEXT("Mode State is read"), reader.IsError());
+	TestTrue(TEXT("SpaceType"), received.SpaceType == sent.SpaceType);
+	TestTrue(TEXT("TransformationType"), received.TransformationType == sent.TransformationType);
+	TestTrue(TEXT("Domain"), received.Domain == sent.Domain);
+	TestTrue(TEXT("bComponentBased"), received.bComponentBased == sent.bComponentBased);
+	TestTrue(TEXT("bRotateOnLocalAxis"), received.bRotateOnLocalAxis == sent.bRotateOnLocalAxis);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
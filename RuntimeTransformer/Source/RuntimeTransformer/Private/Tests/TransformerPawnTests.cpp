@@ -0,0 +1,978 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TransformerPawn.h"
+#include "TransformerTestHelpers.h"
+#include "Components/BoxComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Reaches the steps of the Drag Session & the Transform Commits, which are private to the Pawn
+struct FTransformerPawnTestAccess
+{
+	static void AccumulateDelta(ATransformerPawn& Pawn, const FTransform& DeltaTransform)
+	{
+		ATransformerPawn::AccumulateDeltaTransform(Pawn.DragSession.TotalDeltaTransform, DeltaTransform);
+	}
+
+	static void EvaluateDragSession(ATransformerPawn& Pawn) { Pawn.EvaluateDragSession(); }
+	static void CommitDragSession(ATransformerPawn& Pawn) { Pawn.CommitDragSession(); }
+
+	//What ReplicateFinishTransform sends (before it is split in Chunks & quantized)
+	static void GatherCommittedTransforms(ATransformerPawn& Pawn, TArray<FTransformerCommittedTransform>& OutTransforms)
+	{
+		Pawn.GatherCommittedTransforms(OutTransforms);
+	}
+};
+
+namespace TransformerPawnTests
+{
+	using namespace TransformerTestHelpers;
+
+	//A Game World that lives as long as the Test, with a Transformer Pawn in it
+	struct FTestWorld
+	{
+		FTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			worldContext.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->BeginPlay();
+
+			Pawn = World->SpawnActor<ATransformerPawn>();
+		}
+
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		//An Actor with just a Movable Root
+		AActor* SpawnActor(const FTransform& Transform)
+		{
+			AActor* actor = World->SpawnActor<AActor>();
+			USceneComponent* root = NewObject<USceneComponent>(actor);
+			root->SetMobility(EComponentMobility::Movable);
+			actor->SetRootComponent(root);
+			root->RegisterComponent();
+			root->SetWorldTransform(Transform);
+			return actor;
+		}
+
+		//An Actor with a Movable Static Mesh as its Root
+		AActor* SpawnMeshActor(UStaticMesh* StaticMesh, const FTransform& Transform)
+		{
+			AActor* actor = World->SpawnActor<AActor>();
+			UStaticMeshComponent* mesh = NewObject<UStaticMeshComponent>(actor);
+			mesh->SetMobility(EComponentMobility::Movable);
+			mesh->SetStaticMesh(StaticMesh);
+			actor->SetRootComponent(mesh);
+			mesh->RegisterComponent();
+			mesh->SetWorldTransform(Transform);
+			return actor;
+		}
+
+		/**
+		 * Movable Components (Static Meshes without Collision, if a Mesh is given) scattered around a single Actor,
+		 * for large Selections without spawning an Actor for each
+		 */
+		void SpawnComponents(int32 Count, UStaticMesh* StaticMesh, FRandomStream& Stream, TArray<USceneComponent*>& outComponents)
+		{
+			AActor* actor = SpawnActor(FTransform::Identity);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				USceneComponent* component;
+				if (StaticMesh)
+				{
+					UStaticMeshComponent* mesh = NewObject<UStaticMeshComponent>(actor);
+					mesh->SetStaticMesh(StaticMesh);
+					mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+					component = mesh;
+				}
+				else
+					component = NewObject<USceneComponent>(actor);
+
+				component->SetMobility(EComponentMobility::Movable);
+				component->SetupAttachment(actor->GetRootComponent());
+				component->SetRelativeTransform(FTransform(RandomQuat(Stream), RandomVector(Stream, 10000.f)));
+				component->RegisterComponent();
+				outComponents.Add(component);
+			}
+		}
+
+		UWorld* World;
+		ATransformerPawn* Pawn;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnApplyDeltaTest, "RuntimeTransformer.Pawn.ApplyDeltaTransform"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerPawnApplyDeltaTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	//enough Components for the Evaluation to be split into several parallel Blocks, plus a scalar remainder
+	FRandomStream stream(0xA991);
+	TArray<AActor*> actors;
+	TArray<FTransform> expectedTransforms;
+	for (int32 i = 0; i < 3001; ++i)
+	{
+		const FTransform transform(RandomQuat(stream), RandomVector(stream, 10000.f));
+		actors.Add(testWorld.SpawnActor(transform));
+		expectedTransforms.Add(transform);
+	}
+	testWorld.Pawn->SelectMultipleActors(actors);
+
+	//each Delta without a Domain is a Drag Session of its own: evaluated in Blocks and then committed
+	for (int32 deltaIndex = 0; deltaIndex < 4; ++deltaIndex)
+	{
+		const FQuat deltaRotation = (deltaIndex & 1) ? RandomQuat(stream) : FQuat::Identity;
+		const FVector deltaLocation = RandomVector(stream, 500.f);
+		//Rotations are around the Gizmo, which is placed on (and follows) the Last Selection
+		const FVector pivot = expectedTransforms.Last().GetLocation();
+		testWorld.Pawn->ApplyDeltaTransform(FTransform(deltaRotation, deltaLocation, FVector::ZeroVector));
+
+		for (FTransform& expected : expectedTransforms)
+		{
+			expected = FTransform(deltaRotation * expected.GetRotation()
+				, pivot + deltaRotation.RotateVector(expected.GetLocation() - pivot) + deltaLocation);
+		}
+	}
+
+	for (int32 i = 0; i < actors.Num(); ++i)
+	{
+		const FTransform actual = actors[i]->GetActorTransform();
+		if (!actual.GetLocation().Equals(expectedTransforms[i].GetLocation(), 0.1f)
+			|| !actual.GetRotation().Equals(expectedTransforms[i].GetRotation(), 1.e-3f)
+			|| !actual.GetScale3D().Equals(FVector::OneVector, 1.e-3f))
+		{
+			AddError(FString::Printf(TEXT("Actor %d is at %s, expected %s"), i, *actual.ToString()
+				, *expectedTransforms[i].ToString()));
+			return false;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnInstanceRunsTest, "RuntimeTransformer.Pawn.InstanceRuns"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerPawnInstanceRunsTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	AActor* actor = testWorld.World->SpawnActor<AActor>();
+	UInstancedStaticMeshComponent* instancedMesh = NewObject<UInstancedStaticMeshComponent>(actor);
+	instancedMesh->SetMobility(EComponentMobility::Movable);
+	actor->SetRootComponent(instancedMesh);
+	instancedMesh->RegisterComponent();
+
+	FRandomStream stream(0x13);
+	TArray<FTransform> startTransforms;
+	for (int32 i = 0; i < 256; ++i)
+	{
+		startTransforms.Add(FTransform(RandomQuat(stream), RandomVector(stream, 10000.f)));
+		instancedMesh->AddInstance(startTransforms.Last());
+	}
+
+	//runs of consecutive Instances, lone Instances and gaps, Selected out of order
+	TArray<int32> selectedIndices;
+	for (int32 i = 0; i < startTransforms.Num(); ++i)
+	{
+		if (stream.FRand() < 0.6f)
+			selectedIndices.Add(i);
+	}
+	TArray<int32> selectionOrder = selectedIndices;
+	for (int32 i = selectionOrder.Num() - 1; i > 0; --i)
+		selectionOrder.Swap(i, stream.RandRange(0, i));
+	for (int32 instanceIndex : selectionOrder)
+		testWorld.Pawn->SelectInstance(instancedMesh, instanceIndex, true);
+
+	const FVector deltaLocation = RandomVector(stream, 500.f);
+	testWorld.Pawn->ApplyDeltaTransform(FTransform(FQuat::Identity, deltaLocation, FVector::ZeroVector));
+
+	//only the Selected Instances move, the ones in the gaps between the runs are left untouched
+	for (int32 i = 0; i < startTransforms.Num(); ++i)
+	{
+		const bool bSelected = selectedIndices.Contains(i);
+		const FVector expectedLocation = startTransforms[i].GetLocation() + (bSelected ? deltaLocation : FVector::ZeroVector);
+
+		FTransform actual;
+		instancedMesh->GetInstanceTransform(i, actual, true);
+		if (!actual.GetLocation().Equals(expectedLocation, 0.1f)
+			|| !actual.GetRotation().Equals(startTransforms[i].GetRotation(), 1.e-3f))
+		{
+			AddError(FString::Printf(TEXT("%s Instance %d is at %s, expected %s"), bSelected ? TEXT("Selected") : TEXT("Unselected")
+				, i, *actual.ToString(), *expectedLocation.ToString()));
+			return false;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnDragProxyTest, "RuntimeTransformer.Pawn.DragProxy"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerPawnDragProxyTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	UStaticMesh* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Cube"), cube) || !TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	//the Threshold is not exposed outside the Details Panel
+	FIntProperty* thresholdProperty = FindFProperty<FIntProperty>(ATransformerPawn::StaticClass(), TEXT("ProxyDragThreshold"));
+	if (!TestNotNull(TEXT("ProxyDragThreshold"), thresholdProperty))
+		return false;
+	thresholdProperty->SetPropertyValue_InContainer(testWorld.Pawn, 16);
+
+	FRandomStream stream(0x9A0);
+	TArray<AActor*> actors;
+	TArray<FTransform> startTransforms;
+	for (int32 i = 0; i < 64; ++i)
+	{
+		startTransforms.Add(FTransform(RandomQuat(stream), RandomVector(stream, 5000.f)));
+		actors.Add(testWorld.SpawnMeshActor(cube, startTransforms.Last()));
+	}
+	testWorld.Pawn->SelectMultipleActors(actors);
+
+	auto IsVisible = [](AActor* Actor) { return Actor->GetRootComponent()->IsVisible(); };
+	const FVector deltaLocation = RandomVector(stream, 500.f);
+
+	//while the Proxy is dragged, only the Gizmo's Actor moves. The rest stay in place, hidden behind the Proxy
+	for (int32 pass = 0; pass < 2; ++pass)
+	{
+		const bool bCancel = (pass == 1);
+		testWorld.Pawn->ServerSetDomain(ETransformationDomain::TD_XYZ);
+		testWorld.Pawn->ApplyDeltaTransform(FTransform(FQuat::Identity, deltaLocation, FVector::ZeroVector));
+
+		int32 hiddenCount = 0;
+		for (int32 i = 0; i < actors.Num(); ++i)
+		{
+			if (IsVisible(actors[i])) continue;
+			++hiddenCount;
+			TestTrue(TEXT("Proxied Actor stays in place while dragging")
+				, actors[i]->GetActorLocation().Equals(startTransforms[i].GetLocation(), 0.1f));
+		}
+		TestEqual(TEXT("Proxied Actors"), hiddenCount, actors.Num() - 1);
+
+		if (bCancel)
+			testWorld.Pawn->CancelTransform();
+		else
+			testWorld.Pawn->ClearDomain();
+
+		//when it finishes, every Actor gets its final Transform (or goes back, if Cancelled) and is shown again
+		for (int32 i = 0; i < actors.Num(); ++i)
+		{
+			if (!bCancel)
+				startTransforms[i].AddToTranslation(deltaLocation);
+
+			if (!IsVisible(actors[i]) || !actors[i]->GetActorLocation().Equals(startTransforms[i].GetLocation(), 0.1f))
+			{
+				AddError(FString::Printf(TEXT("%s: Actor %d is at %s (%s), expected %s"), bCancel ? TEXT("Cancel") : TEXT("Finish")
+					, i, *actors[i]->GetActorLocation().ToString(), IsVisible(actors[i]) ? TEXT("visible") : TEXT("hidden")
+					, *startTransforms[i].GetLocation().ToString()));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnTwoPhasePickingTest, "RuntimeTransformer.Pawn.TwoPhasePicking"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerPawnTwoPhasePickingTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	UStaticMesh* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Cube"), cube) || !TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	FBoolProperty* twoPhaseProperty = FindFProperty<FBoolProperty>(ATransformerPawn::StaticClass(), TEXT("bTwoPhasePicking"));
+	if (!TestNotNull(TEXT("bTwoPhasePicking"), twoPhaseProperty))
+		return false;
+
+	//a Cube in front of another one, and a Cube off to the side (the Cube Mesh is 100 units wide)
+	AActor* frontCube = testWorld.SpawnMeshActor(cube, FTransform(FVector(500.f, 0.f, 0.f)));
+	AActor* backCube = testWorld.SpawnMeshActor(cube, FTransform(FVector(1000.f, 0.f, 0.f)));
+	AActor* sideCube = testWorld.SpawnMeshActor(cube, FTransform(FVector(1000.f, 400.f, 0.f)));
+
+	struct FPick
+	{
+		FVector Start;
+		FVector End;
+		AActor* Expected;
+	};
+	const FPick picks[] = {
+		{ FVector::ZeroVector, FVector(5000.f, 0.f, 0.f), frontCube },
+		{ FVector(2000.f, 0.f, 0.f), FVector(-2000.f, 0.f, 0.f), backCube },
+		{ FVector(0.f, 400.f, 0.f), FVector(5000.f, 400.f, 0.f), sideCube },
+		{ FVector(0.f, -400.f, 0.f), FVector(5000.f, -400.f, 0.f), nullptr } };
+
+	//both ways of picking select the same (first Selectable) Object
+	for (int32 twoPhase = 0; twoPhase < 2; ++twoPhase)
+	{
+		twoPhaseProperty->SetPropertyValue_InContainer(testWorld.Pawn, twoPhase != 0);
+		for (const FPick& pick : picks)
+		{
+			testWorld.Pawn->DeselectAll();
+			const bool bTraced = testWorld.Pawn->TraceByChannel(pick.Start, pick.End, ECC_Visibility, TArray<AActor*>());
+			const TArray<USceneComponent*>& selected = testWorld.Pawn->GetSelectedComponents();
+
+			AActor* selectedActor = (selected.Num() == 1) ? selected[0]->GetOwner() : nullptr;
+			if (bTraced != !!pick.Expected || selectedActor != pick.Expected)
+			{
+				AddError(FString::Printf(TEXT("%s picking from %s to %s selected %d Components (%s), expected %s")
+					, twoPhase ? TEXT("Two Phase") : TEXT("Multi Trace"), *pick.Start.ToString(), *pick.End.ToString()
+					, selected.Num(), selectedActor ? *selectedActor->GetName() : TEXT("none")
+					, pick.Expected ? *pick.Expected->GetName() : TEXT("none")));
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnPickCostTest, "RuntimeTransformer.Pawn.PickCost"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTransformerPawnPickCostTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	UStaticMesh* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Cube"), cube) || !TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	FBoolProperty* twoPhaseProperty = FindFProperty<FBoolProperty>(ATransformerPawn::StaticClass(), TEXT("bTwoPhasePicking"));
+	if (!TestNotNull(TEXT("bTwoPhasePicking"), twoPhaseProperty))
+		return false;
+
+	//Cubes stacked along the Ray (the Cube Mesh is 100 units wide), so the Multi Trace hits every one of them
+	const int32 stackSizes[] = { 16, 256, 2048 };
+	const int32 pickCount = 200;
+	const FVector rayStart = FVector::ZeroVector;
+	TArray<AActor*> cubes;
+	double multiTime = 0.0, twoPhaseTime = 0.0;
+	for (int32 stackSize : stackSizes)
+	{
+		while (cubes.Num() < stackSize)
+			cubes.Add(testWorld.SpawnMeshActor(cube, FTransform(FVector(200.f * (cubes.Num() + 1), 0.f, 0.f))));
+		const FVector rayEnd(200.f * (stackSize + 2), 0.f, 0.f);
+
+		//best of a few runs, to not be thrown off by the rest of the machine
+		for (int32 twoPhase = 0; twoPhase < 2; ++twoPhase)
+		{
+			twoPhaseProperty->SetPropertyValue_InContainer(testWorld.Pawn, twoPhase != 0);
+			double bestTime = MAX_dbl;
+			for (int32 run = 0; run < 3; ++run)
+			{
+				const double startTime = FPlatformTime::Seconds();
+				for (int32 pick = 0; pick < pickCount; ++pick)
+				{
+					//without a Selection there is no Gizmo in the way of the Ray
+					testWorld.Pawn->DeselectAll();
+					testWorld.Pawn->TraceByChannel(rayStart, rayEnd, ECC_Visibility, TArray<AActor*>());
+				}
+				bestTime = FMath::Min(bestTime, FPlatformTime::Seconds() - startTime);
+			}
+
+			//either way, the front Cube is the one Selected
+			const TArray<USceneComponent*>& selected = testWorld.Pawn->GetSelectedComponents();
+			TestTrue(TEXT("Front Cube is picked"), selected.Num() == 1 && selected[0]->GetOwner() == cubes[0]);
+			(twoPhase ? twoPhaseTime : multiTime) = bestTime;
+		}
+
+		AddInfo(FString::Printf(TEXT("%d stacked Cubes: Multi Trace %.2f us, Two Phase %.2f us per Pick")
+			, stackSize, multiTime * 1.e6 / pickCount, twoPhaseTime * 1.e6 / pickCount));
+	}
+
+	//the Single Trace stops at the front Cube, while the Multi Trace goes through (and sorts) the whole stack
+	TestTrue(TEXT("Two Phase Picking is cheaper through a deep stack"), twoPhaseTime < multiTime);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnMarqueeTimingTest, "RuntimeTransformer.Pawn.MarqueeTiming"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTransformerPawnMarqueeTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	//50k Boxes (without Collision, the Marquee doesn't need it) under a single Actor, Selected as Components
+	const int32 boxCount = 50000;
+	const float spacing = 100.f;
+	const int32 side = FMath::CeilToInt(FMath::Pow((float)boxCount, 1.f / 3.f));
+	AActor* actor = testWorld.SpawnActor(FTransform::Identity);
+	TArray<UBoxComponent*> boxes;
+	for (int32 i = 0; i < boxCount; ++i)
+	{
+		UBoxComponent* box = NewObject<UBoxComponent>(actor);
+		box->SetMobility(EComponentMobility::Movable);
+		box->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		box->SetBoxExtent(FVector(spacing * 0.25f), false);
+		box->SetupAttachment(actor->GetRootComponent());
+		box->SetRelativeLocation(FVector(i % side, (i / side) % side, i / (side * side)) * spacing);
+		box->RegisterComponent();
+		testWorld.Pawn->RegisterSelectable(box);
+		boxes.Add(box);
+	}
+	testWorld.Pawn->SetComponentBased(true);
+
+	//Marquees over a slab of the grid, from a single layer up to the whole grid
+	const int32 layerCounts[] = { 1, side / 4, side };
+	for (int32 layers : layerCounts)
+	{
+		const FBox marquee(FVector(-spacing * 0.5f), FVector(side, side, layers) * spacing - spacing * 0.5f);
+		const TArray<FPlane> planes = GetBoxPlanes(marquee);
+		const int32 expectedCount = FMath::Min(boxCount, side * side * layers);
+
+		//best of a few runs, to not be thrown off by the rest of the machine
+		double bestTime = MAX_dbl;
+		for (int32 run = 0; run < 3; ++run)
+		{
+			testWorld.Pawn->DeselectAll();
+			const double startTime = FPlatformTime::Seconds();
+			testWorld.Pawn->SelectInFrustum(planes);
+			bestTime = FMath::Min(bestTime, FPlatformTime::Seconds() - startTime);
+		}
+
+		TestEqual(FString::Printf(TEXT("Boxes Selected in %d Layers"), layers), testWorld.Pawn->GetSelectedComponents().Num(), expectedCount);
+		AddInfo(FString::Printf(TEXT("%d registered Boxes, Marquee over %d of %d Layers (%d Selected): %.3f ms")
+			, boxCount, layers, side, expectedCount, bestTime * 1000.0));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnKinematicDragTest, "RuntimeTransformer.Pawn.KinematicDrag"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTransformerPawnKinematicDragTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	UStaticMesh* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Cube"), cube))
+		return false;
+
+	FBoolProperty* kinematicProperty = FindFProperty<FBoolProperty>(ATransformerPawn::StaticClass(), TEXT("bKinematicWhileDragging"));
+	if (!TestNotNull(TEXT("bKinematicWhileDragging"), kinematicProperty))
+		return false;
+
+	//the same Drag of 1k simulating Cubes, with their Bodies kept simulating and then turned kinematic
+	const int32 frameCount = 60;
+	const float frameTime = 1.f / 60.f;
+	double deltaTimes[2] = { 0.0, 0.0 }, stepTimes[2] = { 0.0, 0.0 };
+	for (int32 kinematic = 0; kinematic < 2; ++kinematic)
+	{
+		const bool bKinematic = (kinematic != 0);
+		const TCHAR* mode = bKinematic ? TEXT("Kinematic") : TEXT("Simulating");
+
+		FTestWorld testWorld;
+		if (!TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+			return false;
+		kinematicProperty->SetPropertyValue_InContainer(testWorld.Pawn, bKinematic);
+
+		//a 10x10x10 block of Cubes (100 units wide), close enough to push each other around if they keep simulating
+		FRandomStream stream(0x51D);
+		TArray<AActor*> actors;
+		TArray<UPrimitiveComponent*> bodies;
+		TArray<FVector> linearVelocities, angularVelocities;
+		for (int32 i = 0; i < 1000; ++i)
+		{
+			actors.Add(testWorld.SpawnMeshActor(cube, FTransform(FVector(i % 10, (i / 10) % 10, i / 100) * 105.f)));
+			UPrimitiveComponent* body = CastChecked<UPrimitiveComponent>(actors.Last()->GetRootComponent());
+			body->SetSimulatePhysics(true);
+			linearVelocities.Add(RandomVector(stream, 100.f));
+			angularVelocities.Add(RandomVector(stream, 90.f));
+			body->SetPhysicsLinearVelocity(linearVelocities.Last());
+			body->SetPhysicsAngularVelocityInDegrees(angularVelocities.Last());
+			bodies.Add(body);
+		}
+		testWorld.Pawn->SelectMultipleActors(actors);
+
+		auto CountSimulating = [&bodies]()
+		{
+			int32 count = 0;
+			for (UPrimitiveComponent* body : bodies)
+				count += body->IsSimulatingPhysics() ? 1 : 0;
+			return count;
+		};
+
+		//every frame of the Drag moves the Selection a bit, and then the World (and its Physics Scene) is stepped
+		testWorld.Pawn->ServerSetDomain(ETransformationDomain::TD_XYZ);
+		for (int32 frame = 0; frame < frameCount; ++frame)
+		{
+			double startTime = FPlatformTime::Seconds();
+			testWorld.Pawn->ApplyDeltaTransform(FTransform(FQuat::Identity, FVector(2.f, 0.f, 0.f), FVector::ZeroVector));
+			deltaTimes[kinematic] += FPlatformTime::Seconds() - startTime;
+
+			startTime = FPlatformTime::Seconds();
+			testWorld.World->Tick(LEVELTICK_All, frameTime);
+			stepTimes[kinematic] += FPlatformTime::Seconds() - startTime;
+		}
+		TestEqual(FString::Printf(TEXT("%s: Bodies simulating while dragging"), mode), CountSimulating(), bKinematic ? 0 : bodies.Num());
+
+		testWorld.Pawn->ClearDomain();
+		if (!bKinematic) continue;
+
+		//once released, the Bodies simulate again from the Velocities they were dragged with, woken up
+		TestEqual(TEXT("Bodies simulating after the Drag"), CountSimulating(), bodies.Num());
+		for (int32 i = 0; i < bodies.Num(); ++i)
+		{
+			const FVector linearVelocity = bodies[i]->GetPhysicsLinearVelocity();
+			const FVector angularVelocity = bodies[i]->GetPhysicsAngularVelocityInDegrees();
+			if (!bodies[i]->RigidBodyIsAwake() || !linearVelocity.Equals(linearVelocities[i], 0.01f)
+				|| !angularVelocity.Equals(angularVelocities[i], 0.01f))
+			{
+				AddError(FString::Printf(TEXT("Body %d is %s with Velocities %s / %s, expected awake with %s / %s"), i
+					, bodies[i]->RigidBodyIsAwake() ? TEXT("awake") : TEXT("asleep"), *linearVelocity.ToString(), *angularVelocity.ToString()
+					, *linearVelocities[i].ToString(), *angularVelocities[i].ToString()));
+				break;
+			}
+		}
+	}
+
+	//the Step is the whole World Tick, which is mostly the Physics Step here (nothing else in the World ticks much)
+	for (int32 kinematic = 0; kinematic < 2; ++kinematic)
+	{
+		AddInfo(FString::Printf(TEXT("1k simulating Cubes dragged %s: %.3f ms per Delta, %.3f ms per World Step (%d frames)")
+			, kinematic ? TEXT("kinematic") : TEXT("simulating"), deltaTimes[kinematic] * 1000.0 / frameCount
+			, stepTimes[kinematic] * 1000.0 / frameCount, frameCount));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnDragSessionTimingTest, "RuntimeTransformer.Pawn.DragSessionTiming"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTransformerPawnDragSessionTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	FIntProperty* thresholdProperty = FindFProperty<FIntProperty>(ATransformerPawn::StaticClass(), TEXT("ParallelTransformThreshold"));
+	if (!TestNotNull(TEXT("ParallelTransformThreshold"), thresholdProperty))
+		return false;
+
+	//the Evaluation only goes as wide as there are Workers
+	AddInfo(FString::Printf(TEXT("%d Task Graph Worker Threads"), FTaskGraphInterface::Get().GetNumWorkerThreads()));
+
+	const int32 componentCounts[] = { 1000, 10000, 50000 };
+	const int32 deltaCount = 10;
+	for (int32 componentCount : componentCounts)
+	{
+		FTestWorld testWorld;
+		if (!TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+			return false;
+		ATransformerPawn& pawn = *testWorld.Pawn;
+		const int32 parallelThreshold = thresholdProperty->GetPropertyValue_InContainer(&pawn);
+
+		FRandomStream stream(componentCount);
+		TArray<USceneComponent*> components;
+		testWorld.SpawnComponents(componentCount, nullptr, stream, components);
+		pawn.SetComponentBased(true);
+		pawn.SelectMultipleComponents(components);
+		pawn.ServerSetDomain(ETransformationDomain::TD_XYZ);
+
+		//best of a few Deltas, to not be thrown off by the rest of the machine
+		for (int32 parallel = 0; parallel < 2; ++parallel)
+		{
+			thresholdProperty->SetPropertyValue_InContainer(&pawn, parallel ? parallelThreshold : 0);
+			double evaluateTime = MAX_dbl, commitTime = MAX_dbl;
+			for (int32 deltaIndex = 0; deltaIndex < deltaCount; ++deltaIndex)
+			{
+				FTransformerPawnTestAccess::AccumulateDelta(pawn
+					, FTransform(FQuat(FVector::UpVector, 0.01f), RandomVector(stream, 10.f), FVector::ZeroVector));
+
+				double startTime = FPlatformTime::Seconds();
+				FTransformerPawnTestAccess::EvaluateDragSession(pawn);
+				evaluateTime = FMath::Min(evaluateTime, FPlatformTime::Seconds() - startTime);
+
+				startTime = FPlatformTime::Seconds();
+				FTransformerPawnTestAccess::CommitDragSession(pawn);
+				commitTime = FMath::Min(commitTime, FPlatformTime::Seconds() - startTime);
+			}
+
+			AddInfo(FString::Printf(TEXT("%d Components, %s: Evaluate %.3f ms, Commit %.3f ms")
+				, componentCount, parallel ? *FString::Printf(TEXT("Parallel Threshold %d"), parallelThreshold) : TEXT("single threaded")
+				, evaluateTime * 1000.0, commitTime * 1000.0));
+		}
+
+		//the same Blocks are evaluated either way, so the Transforms are the same too
+		TArray<FTransform> parallelTransforms;
+		for (USceneComponent* component : components)
+			parallelTransforms.Add(component->GetComponentTransform());
+		thresholdProperty->SetPropertyValue_InContainer(&pawn, 0);
+		FTransformerPawnTestAccess::EvaluateDragSession(pawn);
+		FTransformerPawnTestAccess::CommitDragSession(pawn);
+		for (int32 i = 0; i < components.Num(); ++i)
+		{
+			const FTransform& transform = components[i]->GetComponentTransform();
+			if (!transform.GetLocation().Equals(parallelTransforms[i].GetLocation(), 0.f)
+				|| !transform.GetRotation().Equals(parallelTransforms[i].GetRotation(), 0.f))
+			{
+				AddError(FString::Printf(TEXT("%d Components: Component %d is at %s single threaded, %s in parallel"), componentCount
+					, i, *transform.ToString(), *parallelTransforms[i].ToString()));
+				break;
+			}
+		}
+
+		pawn.ClearDomain();
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnDragProxyTimingTest, "RuntimeTransformer.Pawn.DragProxyTiming"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTransformerPawnDragProxyTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	UStaticMesh* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Cube"), cube) || !TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	FIntProperty* thresholdProperty = FindFProperty<FIntProperty>(ATransformerPawn::StaticClass(), TEXT("ProxyDragThreshold"));
+	if (!TestNotNull(TEXT("ProxyDragThreshold"), thresholdProperty))
+		return false;
+
+	FRandomStream stream(0x9A1);
+	TArray<USceneComponent*> components;
+	testWorld.SpawnComponents(10000, cube, stream, components);
+	testWorld.Pawn->SetComponentBased(true);
+	testWorld.Pawn->SelectMultipleComponents(components);
+
+	//the same Drag of the same Selection, moving the Components themselves and then a Proxy (the Threshold below the Selection)
+	const int32 thresholds[] = { 0, components.Num() / 2 };
+	const int32 deltaCount = 30;
+	for (int32 threshold : thresholds)
+	{
+		thresholdProperty->SetPropertyValue_InContainer(testWorld.Pawn, threshold);
+
+		double startTime = FPlatformTime::Seconds();
+		testWorld.Pawn->ServerSetDomain(ETransformationDomain::TD_XYZ);
+		const double beginTime = FPlatformTime::Seconds() - startTime;
+
+		//best of the Deltas, to not be thrown off by the rest of the machine
+		double deltaTime = MAX_dbl;
+		for (int32 deltaIndex = 0; deltaIndex < deltaCount; ++deltaIndex)
+		{
+			startTime = FPlatformTime::Seconds();
+			testWorld.Pawn->ApplyDeltaTransform(FTransform(FQuat::Identity, RandomVector(stream, 10.f), FVector::ZeroVector));
+			deltaTime = FMath::Min(deltaTime, FPlatformTime::Seconds() - startTime);
+		}
+
+		//the Proxy leaves every Component but the Gizmo's in place until the Drag finishes
+		int32 hiddenCount = 0;
+		for (USceneComponent* component : components)
+			hiddenCount += component->IsVisible() ? 0 : 1;
+		TestEqual(FString::Printf(TEXT("Threshold %d: Components behind the Proxy"), threshold)
+			, hiddenCount, threshold > 0 ? components.Num() - 1 : 0);
+
+		startTime = FPlatformTime::Seconds();
+		testWorld.Pawn->ClearDomain();
+		const double endTime = FPlatformTime::Seconds() - startTime;
+
+		AddInfo(FString::Printf(TEXT("%d Components, Proxy Drag Threshold %d: begin %.3f ms, %.3f ms per Delta, finish %.3f ms")
+			, components.Num(), threshold, beginTime * 1000.0, deltaTime * 1000.0, endTime * 1000.0));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnHierarchicalInstancesTest, "RuntimeTransformer.Pawn.HierarchicalInstances"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTransformerPawnHierarchicalInstancesTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	UStaticMesh* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	FTestWorld testWorld;
+	if (!TestNotNull(TEXT("Cube"), cube) || !TestNotNull(TEXT("Pawn"), testWorld.Pawn))
+		return false;
+
+	//10k Instances over a few Hierarchical Instanced Meshes
+	const int32 meshCount = 4;
+	const int32 instancesPerMesh = 2500;
+	FRandomStream stream(0x415);
+	TArray<UHierarchicalInstancedStaticMeshComponent*> hierarchicalMeshes;
+	for (int32 meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+	{
+		AActor* actor = testWorld.World->SpawnActor<AActor>();
+		UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh = NewObject<UHierarchicalInstancedStaticMeshComponent>(actor);
+		hierarchicalMesh->SetMobility(EComponentMobility::Movable);
+		hierarchicalMesh->SetStaticMesh(cube);
+		actor->SetRootComponent(hierarchicalMesh);
+		hierarchicalMesh->RegisterComponent();
+		for (int32 i = 0; i < instancesPerMesh; ++i)
+			hierarchicalMesh->AddInstance(FTransform(RandomQuat(stream), RandomVector(stream, 10000.f)));
+		hierarchicalMeshes.Add(hierarchicalMesh);
+	}
+
+	//the Trees are built asynchronously, and applied in the Game Thread
+	auto WaitForTrees = [&hierarchicalMeshes]()
+	{
+		const double timeoutTime = FPlatformTime::Seconds() + 30.0;
+		for (;;)
+		{
+			bool bBuilding = false;
+			for (UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh : hierarchicalMeshes)
+				bBuilding |= hierarchicalMesh->IsAsyncBuilding();
+			if (!bBuilding) return true;
+			if (FPlatformTime::Seconds() > timeoutTime) return false;
+
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.001f);
+		}
+	};
+	if (!TestTrue(TEXT("Trees are built before the Drag"), WaitForTrees()))
+		return false;
+
+	//a Tree rebuilt is a new Cluster Tree
+	auto GetClusterTrees = [&hierarchicalMeshes]()
+	{
+		TArray<const void*> clusterTrees;
+		for (UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh : hierarchicalMeshes)
+			clusterTrees.Add(hierarchicalMesh->ClusterTreePtr.Get());
+		return clusterTrees;
+	};
+	const TArray<const void*> builtTrees = GetClusterTrees();
+
+	for (UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh : hierarchicalMeshes)
+	{
+		for (int32 i = 0; i < instancesPerMesh; ++i)
+			testWorld.Pawn->SelectInstance(hierarchicalMesh, i, true);
+	}
+
+	//while dragging, the Trees are left outdated rather than rebuilt on every update
+	testWorld.Pawn->ServerSetDomain(ETransformationDomain::TD_XYZ);
+	const int32 deltaCount = 30;
+	double deltaTime = 0.0;
+	int32 rebuildsWhileDragging = 0;
+	for (int32 deltaIndex = 0; deltaIndex < deltaCount; ++deltaIndex)
+	{
+		const double startTime = FPlatformTime::Seconds();
+		testWorld.Pawn->ApplyDeltaTransform(FTransform(FQuat::Identity, RandomVector(stream, 10.f), FVector::ZeroVector));
+		deltaTime += FPlatformTime::Seconds() - startTime;
+		testWorld.World->Tick(LEVELTICK_All, 1.f / 60.f);
+
+		for (int32 meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+		{
+			UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh = hierarchicalMeshes[meshIndex];
+			if (hierarchicalMesh->bAutoRebuildTreeOnInstanceChanges || hierarchicalMesh->IsAsyncBuilding()
+				|| hierarchicalMesh->ClusterTreePtr.Get() != builtTrees[meshIndex])
+				++rebuildsWhileDragging;
+		}
+	}
+	TestEqual(TEXT("Trees rebuilt (or about to) while dragging"), rebuildsWhileDragging, 0);
+
+	//the Drag finishes with a single rebuild of each Tree
+	double startTime = FPlatformTime::Seconds();
+	testWorld.Pawn->ClearDomain();
+	const double finishTime = FPlatformTime::Seconds() - startTime;
+
+	startTime = FPlatformTime::Seconds();
+	TestTrue(TEXT("Trees are rebuilt after the Drag"), WaitForTrees());
+	const double rebuildTime = FPlatformTime::Seconds() - startTime;
+
+	const TArray<const void*> rebuiltTrees = GetClusterTrees();
+	for (int32 meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+	{
+		UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh = hierarchicalMeshes[meshIndex];
+		TestTrue(TEXT("Tree rebuilds on Instance changes again"), hierarchicalMesh->bAutoRebuildTreeOnInstanceChanges);
+		TestTrue(TEXT("Tree is rebuilt once the Drag finishes"), rebuiltTrees[meshIndex] != builtTrees[meshIndex]);
+		TestTrue(TEXT("Tree is up to date"), hierarchicalMesh->IsTreeFullyBuilt());
+	}
+
+	AddInfo(FString::Printf(TEXT("%d Instances over %d Hierarchical Instanced Meshes: %.3f ms per Delta, finish %.3f ms, Tree rebuild %.3f ms")
+		, meshCount * instancesPerMesh, meshCount, deltaTime * 1000.0 / deltaCount, finishTime * 1000.0, rebuildTime * 1000.0));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransformerPawnCommitConvergenceTest, "RuntimeTransformer.Pawn.CommitConvergence"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTransformerPawnCommitConvergenceTest::RunTest(const FString& Parameters)
+{
+	using namespace TransformerPawnTests;
+
+	FTestWorld testWorld;
+	ATransformerPawn* remotePawn = testWorld.World->SpawnActor<ATransformerPawn>();
+	if (!TestNotNull(TEXT("Pawn"), testWorld.Pawn) || !TestNotNull(TEXT("Remote Pawn"), remotePawn))
+		return false;
+
+	//small Chunks, so that every Commit is split in a few
+	FIntProperty* chunkSizeProperty = FindFProperty<FIntProperty>(ATransformerPawn::StaticClass(), TEXT("TransformCommitChunkSize"));
+	if (!TestNotNull(TEXT("TransformCommitChunkSize"), chunkSizeProperty))
+		return false;
+	const int32 chunkSize = 7;
+	chunkSizeProperty->SetPropertyValue_InContainer(testWorld.Pawn, chunkSize);
+
+	//The Scene the Dragging Pawn moves, and the same Scene as the Remote Pawn has it (what a Client would have replicated).
+	// Every Actor has two Children following its Root, and there is an Instanced Mesh
+	struct FScene
+	{
+		TArray<USceneComponent*> Roots;
+		TArray<USceneComponent*> Components;
+		UInstancedStaticMeshComponent* InstancedMesh;
+	};
+	const int32 actorCount = 24;
+	const int32 instanceCount = 32;
+	auto BuildScene = [&testWorld, actorCount, instanceCount]()
+	{
+		FScene scene;
+		FRandomStream stream(0xC0);
+		for (int32 i = 0; i < actorCount; ++i)
+		{
+			AActor* actor = testWorld.SpawnActor(FTransform(RandomQuat(stream), RandomVector(stream, 5000.f)));
+			scene.Roots.Add(actor->GetRootComponent());
+			scene.Components.Add(actor->GetRootComponent());
+			for (int32 childIndex = 0; childIndex < 2; ++childIndex)
+			{
+				USceneComponent* child = NewObject<USceneComponent>(actor);
+				child->SetMobility(EComponentMobility::Movable);
+				child->SetupAttachment(actor->GetRootComponent());
+				child->SetRelativeTransform(FTransform(RandomQuat(stream), RandomVector(stream, 200.f)));
+				child->RegisterComponent();
+				scene.Components.Add(child);
+			}
+		}
+
+		AActor* actor = testWorld.World->SpawnActor<AActor>();
+		scene.InstancedMesh = NewObject<UInstancedStaticMeshComponent>(actor);
+		scene.InstancedMesh->SetMobility(EComponentMobility::Movable);
+		actor->SetRootComponent(scene.InstancedMesh);
+		scene.InstancedMesh->RegisterComponent();
+		for (int32 i = 0; i < instanceCount; ++i)
+			scene.InstancedMesh->AddInstance(FTransform(RandomQuat(stream), RandomVector(stream, 5000.f)));
+		return scene;
+	};
+	const FScene localScene = BuildScene();
+	const FScene remoteScene = BuildScene();
+
+	//what the Network would resolve the Components of a Commit to on the Remote side
+	TMap<USceneComponent*, USceneComponent*> remoteComponents;
+	for (int32 i = 0; i < localScene.Components.Num(); ++i)
+		remoteComponents.Add(localScene.Components[i], remoteScene.Components[i]);
+	remoteComponents.Add(localScene.InstancedMesh, remoteScene.InstancedMesh);
+
+	//the Roots and some of their (Selected) Children, and every other Instance.
+	// The Server does not have the last few Roots Selected, so their Transforms are filtered out of the Commits
+	const int32 unselectedRemoteRoots = 3;
+	auto SelectScene = [instanceCount](ATransformerPawn* Pawn, const FScene& Scene, int32 SelectedRoots)
+	{
+		Pawn->SetComponentBased(true);
+		TArray<USceneComponent*> selection;
+		for (int32 i = 0; i < SelectedRoots; ++i)
+		{
+			selection.Add(Scene.Roots[i]);
+			if (i % 3 == 0)
+				selection.Add(Scene.Components[i * 3 + 1]);
+		}
+		Pawn->SelectMultipleComponents(selection);
+		for (int32 i = 0; i < instanceCount; i += 2)
+			Pawn->SelectInstance(Scene.InstancedMesh, i, true);
+	};
+	SelectScene(testWorld.Pawn, localScene, actorCount);
+	SelectScene(remotePawn, remoteScene, actorCount - unselectedRemoteRoots);
+
+	TArray<FTransform> remoteStartTransforms;
+	for (USceneComponent* component : remoteScene.Components)
+		remoteStartTransforms.Add(component->GetComponentTransform());
+
+	FRandomStream stream(0xC1);
+	for (int32 drag = 0; drag < 8; ++drag)
+	{
+		testWorld.Pawn->ServerSetDomain(ETransformationDomain::TD_XYZ);
+		const int32 deltaCount = stream.RandRange(1, 5);
+		for (int32 deltaIndex = 0; deltaIndex < deltaCount; ++deltaIndex)
+		{
+			const FQuat deltaRotation = (stream.FRand() < 0.5f) ? RandomQuat(stream) : FQuat::Identity;
+			testWorld.Pawn->ApplyDeltaTransform(FTransform(deltaRotation, RandomVector(stream, 300.f), FVector::ZeroVector));
+		}
+
+		TArray<FTransformerCommittedTransform> sentTransforms;
+		FTransformerPawnTestAccess::GatherCommittedTransforms(*testWorld.Pawn, sentTransforms);
+		testWorld.Pawn->ReplicateFinishTransform();
+
+		//the same Chunks the Dragging Pawn sent, resolved on the Remote side and received through the Server
+		FTransformerTransformCommit commit;
+		for (int32 first = 0; first < sentTransforms.Num(); first += chunkSize)
+		{
+			commit.Transforms.Reset();
+			for (int32 i = first; i < FMath::Min(first + chunkSize, sentTransforms.Num()); ++i)
+			{
+				const FTransformerCommittedTransform& sent = sentTransforms[i];
+				commit.Transforms.Emplace(remoteComponents.FindRef(sent.Component), sent.InstanceIndex, sent.Transform);
+			}
+			commit.Quantize();
+			remotePawn->ServerCommitTransforms(commit);
+			++commit.ChunkIndex;
+		}
+	}
+
+	//Transforms are compared bit for bit: everyone has to end up exactly like the Dragging Pawn
+	auto IsSameTransform = [](const FTransform& A, const FTransform& B)
+	{
+		return A.GetLocation() == B.GetLocation() && A.GetRotation() == B.GetRotation() && A.GetScale3D() == B.GetScale3D();
+	};
+
+	for (int32 i = 0; i < localScene.Components.Num(); ++i)
+	{
+		//the Children (Selected or not) follow their Roots
+		const bool bFiltered = (i / 3) >= actorCount - unselectedRemoteRoots;
+		const FTransform& remoteTransform = remoteScene.Components[i]->GetComponentTransform();
+		const FTransform& expectedTransform = bFiltered ? remoteStartTransforms[i] : localScene.Components[i]->GetComponentTransform();
+		if (!IsSameTransform(remoteTransform, expectedTransform))
+		{
+			AddError(FString::Printf(TEXT("%s Component %d is at %s remotely, expected %s"), bFiltered ? TEXT("Filtered") : TEXT("Committed")
+				, i, *remoteTransform.ToString(), *expectedTransform.ToString()));
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < instanceCount; ++i)
+	{
+		FTransform localTransform, remoteTransform;
+		localScene.InstancedMesh->GetInstanceTransform(i, localTransform, true);
+		remoteScene.InstancedMesh->GetInstanceTransform(i, remoteTransform, true);
+		if (!IsSameTransform(remoteTransform, localTransform))
+		{
+			AddError(FString::Printf(TEXT("Instance %d is at %s remotely, %s locally"), i, *remoteTransform.ToString(), *localTransform.ToString()));
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,32 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Random values (and other helpers) shared by the Runtime Transformer Automation Tests
+namespace TransformerTestHelpers
+{
+	inline FVector RandomVector(FRandomStream& Stream, float Range)
+	{
+		return FVector(Stream.FRandRange(-Range, Range), Stream.FRandRange(-Range, Range), Stream.FRandRange(-Range, Range));
+	}
+
+	inline FQuat RandomQuat(FRandomStream& Stream)
+	{
+		return FQuat(Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f)
+			, Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f)).GetNormalized();
+	}
+
+	//The (outward facing) Planes of an Axis Aligned Box, the Volume a Marquee selects in an Orthographic View
+	inline TArray<FPlane> GetBoxPlanes(const FBox& Box)
+	{
+		return { FPlane(Box.Max, FVector::ForwardVector), FPlane(Box.Min, FVector::BackwardVector)
+			, FPlane(Box.Max, FVector::RightVector), FPlane(Box.Min, FVector::LeftVector)
+			, FPlane(Box.Max, FVector::UpVector), FPlane(Box.Min, FVector::DownVector) };
+	}
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,252 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerMath.h"
+#include "RuntimeTransformer.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarTransformerUseSIMDKernel(
+	TEXT("RuntimeTransformer.UseSIMDKernel"),
+	1,
+	TEXT("Whether the Transformer Pawn applies Delta Transforms with the SIMD kernel (1) or the scalar one (0)."),
+	ECVF_Default);
+
+void FTransformSoA::SetNum(int32 Number)
+{
+	LocationX.SetNumUninitialized(Number);
+	LocationY.SetNumUninitialized(Number);
+	LocationZ.SetNumUninitialized(Number);
+	RotationX.SetNumUninitialized(Number);
+	RotationY.SetNumUninitialized(Number);
+	RotationZ.SetNumUninitialized(Number);
+	RotationW.SetNumUninitialized(Number);
+	ScaleX.SetNumUninitialized(Number);
+	ScaleY.SetNumUninitialized(Number);
+	ScaleZ.SetNumUninitialized(Number);
+}
+
+void FTransformSoA::Reset()
+{
+	LocationX.Reset();
+	LocationY.Reset();
+	LocationZ.Reset();
+	RotationX.Reset();
+	RotationY.Reset();
+	RotationZ.Reset();
+	RotationW.Reset();
+	ScaleX.Reset();
+	ScaleY.Reset();
+	ScaleZ.Reset();
+}
+
+void FTransformSoA::Add(const FTransform& Transform)
+{
+	const int32 index = Num();
+	SetNum(index + 1);
+	SetTransform(index, Transform);
+}
+
+void FTransformSoA::SetTransform(int32 Index, const FTransform& Transform)
+{
+	const FVector location = Transform.GetLocation();
+	const FQuat rotation = Transform.GetRotation();
+	const FVector scale = Transform.GetScale3D();
+
+	LocationX[Index] = location.X;
+	LocationY[Index] = location.Y;
+	LocationZ[Index] = location.Z;
+	RotationX[Index] = rotation.X;
+	RotationY[Index] = rotation.Y;
+	RotationZ[Index] = rotation.Z;
+	RotationW[Index] = rotation.W;
+	ScaleX[Index] = scale.X;
+	ScaleY[Index] = scale.Y;
+	ScaleZ[Index] = scale.Z;
+}
+
+FTransform FTransformSoA::GetTransform(int32 Index) const
+{
+	return FTransform(
+		FQuat(RotationX[Index], RotationY[Index], RotationZ[Index], RotationW[Index]),
+		FVector(LocationX[Index], LocationY[Index], LocationZ[Index]),
+		FVector(ScaleX[Index], ScaleY[Index], ScaleZ[Index]));
+}
+
+// Lane-wise Cross Product of 4 vectors (A) with 4 vectors (B), each given by their X, Y, Z registers
+static FORCEINLINE void VectorCrossSoA(
+	const VectorRegister& AX, const VectorRegister& AY, const VectorRegister& AZ,
+	const VectorRegister& BX, const VectorRegister& BY, const VectorRegister& BZ,
+	VectorRegister& outX, VectorRegister& outY, VectorRegister& outZ)
+{
+	outX = VectorSubtract(VectorMultiply(AY, BZ), VectorMultiply(AZ, BY));
+	outY = VectorSubtract(VectorMultiply(AZ, BX), VectorMultiply(AX, BZ));
+	outZ = VectorSubtract(VectorMultiply(AX, BY), VectorMultiply(AY, BX));
+}
+
+// Lane-wise version of FQuat::RotateVector: V + (W * T) + Cross(Q, T), with T = 2 * Cross(Q, V)
+// Unrotating is the same but with the negated Quat Axis (QX, QY, QZ)
+static FORCEINLINE void VectorQuatRotateSoA(
+	const VectorRegister& QX, const VectorRegister& QY, const VectorRegister& QZ, const VectorRegister& QW,
+	VectorRegister& X, VectorRegister& Y, VectorRegister& Z)
+{
+	const VectorRegister two = VectorSetFloat1(2.f);
+
+	VectorRegister tX, tY, tZ;
+	VectorCrossSoA(QX, QY, QZ, X, Y, Z, tX, tY, tZ);
+	tX = VectorMultiply(tX, two);
+	tY = VectorMultiply(tY, two);
+	tZ = VectorMultiply(tZ, two);
+
+	VectorRegister cX, cY, cZ;
+	VectorCrossSoA(QX, QY, QZ, tX, tY, tZ, cX, cY, cZ);
+
+	X = VectorAdd(VectorMultiplyAdd(QW, tX, X), cX);
+	Y = VectorAdd(VectorMultiplyAdd(QW, tY, Y), cY);
+	Z = VectorAdd(VectorMultiplyAdd(QW, tZ, Z), cZ);
+}
+
+void FTransformerMath::ApplyDeltaTransform(const FTransformSoA& StartTransforms, FTransformSoA& outTransforms
+	, int32 BeginIndex, int32 EndIndex
+	, const FTransform& DeltaTransform, const FVector& Pivot, bool bRotateOnLocalAxis)
+{
+	check(outTransforms.Num() >= StartTransforms.Num());
+	check(BeginIndex >= 0 && EndIndex <= StartTransforms.Num());
+
+	int32 i = BeginIndex;
+
+	if (CVarTransformerUseSIMDKernel.GetValueOnAnyThread() != 0)
+	{
+		const FQuat deltaRotation = DeltaTransform.GetRotation();
+		const FVector deltaLocation = DeltaTransform.GetLocation();
+		const FVector deltaScale = DeltaTransform.GetScale3D();
+
+		// Uniforms (same for every Transform)
+		const VectorRegister dX = VectorSetFloat1(deltaRotation.X);
+		const VectorRegister dY = VectorSetFloat1(deltaRotation.Y);
+		const VectorRegister dZ = VectorSetFloat1(deltaRotation.Z);
+		const VectorRegister dW = VectorSetFloat1(deltaRotation.W);
+
+		const VectorRegister pX = VectorSetFloat1(Pivot.X);
+		const VectorRegister pY = VectorSetFloat1(Pivot.Y);
+		const VectorRegister pZ = VectorSetFloat1(Pivot.Z);
+
+		// Pivot + Delta Location is added after the rotation
+		const VectorRegister oX = VectorSetFloat1(Pivot.X + deltaLocation.X);
+		const VectorRegister oY = VectorSetFloat1(Pivot.Y + deltaLocation.Y);
+		const VectorRegister oZ = VectorSetFloat1(Pivot.Z + deltaLocation.Z);
+
+		const VectorRegister sX = VectorSetFloat1(deltaScale.X);
+		const VectorRegister sY = VectorSetFloat1(deltaScale.Y);
+		const VectorRegister sZ = VectorSetFloat1(deltaScale.Z);
+
+		for (; i + 4 <= EndIndex; i += 4)
+		{
+			/* LOCATION */
+			VectorRegister lX = VectorSubtract(VectorLoad(StartTransforms.LocationX.GetData() + i), pX);
+			VectorRegister lY = VectorSubtract(VectorLoad(StartTransforms.LocationY.GetData() + i), pY);
+			VectorRegister lZ = VectorSubtract(VectorLoad(StartTransforms.LocationZ.GetData() + i), pZ);
+
+			if (false == bRotateOnLocalAxis)
+				VectorQuatRotateSoA(dX, dY, dZ, dW, lX, lY, lZ);
+
+			VectorStore(VectorAdd(lX, oX), outTransforms.LocationX.GetData() + i);
+			VectorStore(VectorAdd(lY, oY), outTransforms.LocationY.GetData() + i);
+			VectorStore(VectorAdd(lZ, oZ), outTransforms.LocationZ.GetData() + i);
+
+			/* ROTATION (Delta * Start) */
+			const VectorRegister qX = VectorLoad(StartTransforms.RotationX.GetData() + i);
+			const VectorRegister qY = VectorLoad(StartTransforms.RotationY.GetData() + i);
+			const VectorRegister qZ = VectorLoad(StartTransforms.RotationZ.GetData() + i);
+			const VectorRegister qW = VectorLoad(StartTransforms.RotationW.GetData() + i);
+
+			VectorRegister rX = VectorMultiply(dW, qX);
+			rX = VectorMultiplyAdd(dX, qW, rX);
+			rX = VectorMultiplyAdd(dY, qZ, rX);
+			rX = VectorSubtract(rX, VectorMultiply(dZ, qY));
+
+			VectorRegister rY = VectorMultiply(dW, qY);
+			rY = VectorSubtract(rY, VectorMultiply(dX, qZ));
+			rY = VectorMultiplyAdd(dY, qW, rY);
+			rY = VectorMultiplyAdd(dZ, qX, rY);
+
+			VectorRegister rZ = VectorMultiply(dW, qZ);
+			rZ = VectorMultiplyAdd(dX, qY, rZ);
+			rZ = VectorSubtract(rZ, VectorMultiply(dY, qX));
+			rZ = VectorMultiplyAdd(dZ, qW, rZ);
+
+			VectorRegister rW = VectorMultiply(dW, qW);
+			rW = VectorSubtract(rW, VectorMultiply(dX, qX));
+			rW = VectorSubtract(rW, VectorMultiply(dY, qY));
+			rW = VectorSubtract(rW, VectorMultiply(dZ, qZ));
+
+			VectorStore(rX, outTransforms.RotationX.GetData() + i);
+			VectorStore(rY, outTransforms.RotationY.GetData() + i);
+			VectorStore(rZ, outTransforms.RotationZ.GetData() + i);
+			VectorStore(rW, outTransforms.RotationW.GetData() + i);
+
+			/* SCALE (Delta Scale unrotated to local space, by the Start Rotation) */
+			VectorRegister scaleX = sX, scaleY = sY, scaleZ = sZ;
+			VectorQuatRotateSoA(VectorNegate(qX), VectorNegate(qY), VectorNegate(qZ), qW, scaleX, scaleY, scaleZ);
+
+			VectorStore(VectorAdd(scaleX, VectorLoad(StartTransforms.ScaleX.GetData() + i)), outTransforms.ScaleX.GetData() + i);
+			VectorStore(VectorAdd(scaleY, VectorLoad(StartTransforms.ScaleY.GetData() + i)), outTransforms.ScaleY.GetData() + i);
+			VectorStore(VectorAdd(scaleZ, VectorLoad(StartTransforms.ScaleZ.GetData() + i)), outTransforms.ScaleZ.GetData() + i);
+		}
+	}
+
+	//Remainder (or everything, if the SIMD kernel is disabled)
+	ApplyDeltaTransform_Scalar(StartTransforms, outTransforms, i, EndIndex, DeltaTransform, Pivot, bRotateOnLocalAxis);
+}
+
+void FTransformerMath::ApplyDeltaTransform_Scalar(const FTransformSoA& StartTransforms, FTransformSoA& outTransforms
+	, int32 BeginIndex, int32 EndIndex
+	, const FTransform& DeltaTransform, const FVector& Pivot, bool bRotateOnLocalAxis)
+{
+	const FQuat deltaRotation = DeltaTransform.GetRotation();
+
+	for (int32 i = BeginIndex; i < EndIndex; ++i)
+	{
+		const FTransform startTransform = StartTransforms.GetTransform(i);
+
+		FVector deltaLocation = startTransform.GetLocation() - Pivot;
+
+		//DeltaScale is Unrotated Scale to Get Local Scale since World Scale is not supported
+		FVector deltaScale = startTransform.GetRotation()
+			.UnrotateVector(DeltaTransform.GetScale3D());
+
+		if (false == bRotateOnLocalAxis)
+			deltaLocation = deltaRotation.RotateVector(deltaLocation);
+
+		outTransforms.SetTransform(i, FTransform(
+			deltaRotation * startTransform.GetRotation(),
+			//adding Pivot + deltaLocation
+			// (i.e. location from Pivot to Object after optional Rotating)
+			// + deltaTransform Location Offset
+			deltaLocation + Pivot + DeltaTransform.GetLocation(),
+			deltaScale + startTransform.GetScale3D()));
+	}
+}
+
+bool FTransformerMath::IntersectRayBox(const FVector& RayStart, const FVector& RayDirection, const FBox& Box, float& outTime)
+{
+	float timeIn = 0.f, timeOut = 1.f;
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		const float start = RayStart[axis];
+		const float direction = RayDirection[axis];
+		if (FMath::IsNearlyZero(direction))
+		{
+			//parallel to the slab, so it must already be within it
+			if (start < Box.Min[axis] || start > Box.Max[axis]) return false;
+			continue;
+		}
+		float t0 = (Box.Min[axis] - start) / direction;
+		float t1 = (Box.Max[axis] - start) / direction;
+		if (t0 > t1) Swap(t0, t1);
+		timeIn = FMath::Max(timeIn, t0);
+		timeOut = FMath::Min(timeOut, t1);
+		if (timeIn > timeOut) return false;
+	}
+	outTime = timeIn;
+	return true;
+}
@@ -0,0 +1,371 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerNetTypes.h"
+#include "Components/SceneComponent.h"
+#include "Engine/NetSerialization.h"
+#include "UObject/CoreNet.h"
+
+namespace TransformerNetQuantize
+{
+	//the 3 smallest components of a normalized Quaternion are within [-1/Sqrt(2), 1/Sqrt(2)]
+	static const float QuatComponentRange = 0.70710678f;
+	static const uint32 QuatComponentBits = 15;
+	static const uint32 QuatComponentMax = (1 << QuatComponentBits) - 1;
+
+	//How far the rebuilt largest component is kept above the rest, so that it's picked again when re-sent
+	static const float QuatLargestMargin = 1.e-6f;
+
+	//Off by less than this, a Quaternion is sent as it is (Normalizing would move the components off their quantized values)
+	static const float QuatNormalizedTolerance = 1.e-3f;
+
+	//Interpolation from one Sample to the next is kept within these (in seconds)
+	static const float MinSampleDuration = 1.f / 120.f;
+	static const float MaxSampleDuration = 0.5f;
+
+	//Upper bound of the Transforms a single Commit (Chunk) can carry, so bad data can't make us allocate a lot
+	static const uint32 MaxCommitTransforms = 4096;
+
+	/**
+	 * Serializes the Components as their Network GUIDs. When loading, Components that can't be resolved
+	 * are left as nullptr and their (valid) GUIDs are added to OutUnresolved
+	 */
+	static bool SerializeComponents(FArchive& Ar, UPackageMap* Map, TArray<USceneComponent*>& Components
+		, TArray<FNetworkGUID>& OutUnresolved)
+	{
+		uint32 count = Components.Num();
+		Ar.SerializeIntPacked(count);
+		if (Ar.IsLoading())
+		{
+			if (count > (uint32)FTransformerSelectionDelta::MaxComponents)
+			{
+				Ar.SetError();
+				return false;
+			}
+			Components.SetNum(count);
+			OutUnresolved.Reset();
+		}
+
+		for (USceneComponent*& component : Components)
+		{
+			UObject* object = component;
+			FNetworkGUID netGUID;
+			//not being able to map the Object is expected here (that's what OutUnresolved is for)
+			if (Map)
+				Map->SerializeObject(Ar, USceneComponent::StaticClass(), object, &netGUID);
+			component = Cast<USceneComponent>(object);
+
+			if (Ar.IsLoading() && !component && netGUID.IsValid())
+				OutUnresolved.Add(netGUID);
+		}
+		return !Ar.IsError();
+	}
+}
+
+void FTransformerNetQuantize::SerializeQuat(FQuat& Quat, FArchive& Ar)
+{
+	using namespace TransformerNetQuantize;
+
+	uint32 largestIndex = 0;
+	uint32 values[3] = { 0, 0, 0 };
+
+	if (Ar.IsSaving())
+	{
+		FQuat quat = (FMath::Abs(1.f - Quat.SizeSquared()) <= QuatNormalizedTolerance) ? Quat : Quat.GetNormalized();
+		float components[4] = { quat.X, quat.Y, quat.Z, quat.W };
+
+		for (uint32 i = 1; i < 4; ++i)
+		{
+			if (FMath::Abs(components[i]) > FMath::Abs(components[largestIndex]))
+				largestIndex = i;
+		}
+
+		//Q and -Q are the same Rotation, so the largest component is always made positive (and not sent)
+		const float sign = (components[largestIndex] < 0.f) ? -1.f : 1.f;
+		for (uint32 i = 0, v = 0; i < 4; ++i)
+		{
+			if (i == largestIndex) continue;
+			const float normalized = (sign * components[i] / QuatComponentRange + 1.f) * 0.5f;
+			values[v++] = (uint32)FMath::Clamp(FMath::RoundToInt(normalized * QuatComponentMax), 0, (int32)QuatComponentMax);
+		}
+	}
+
+	Ar.SerializeInt(largestIndex, 4);
+	for (uint32& value : values)
+		Ar.SerializeInt(value, QuatComponentMax + 1);
+
+	if (Ar.IsLoading())
+	{
+		float components[4];
+		float sumSquared = 0.f;
+		float largestOther = 0.f;
+		for (uint32 i = 0, v = 0; i < 4; ++i)
+		{
+			if (i == largestIndex) continue;
+			components[i] = ((float)values[v++] / QuatComponentMax * 2.f - 1.f) * QuatComponentRange;
+			sumSquared += components[i] * components[i];
+			largestOther = FMath::Max(largestOther, FMath::Abs(components[i]));
+		}
+
+		//when 2 components were (nearly) tied, the quantization error can make the rebuilt one the smaller,
+		// and a Commit relayed by the Server would then be quantized differently the second time
+		components[largestIndex] = FMath::Max(FMath::Sqrt(FMath::Max(0.f, 1.f - sumSquared)), largestOther + QuatLargestMargin);
+
+		Quat = FQuat(components[0], components[1], components[2], components[3]);
+		if (FMath::Abs(1.f - Quat.SizeSquared()) > QuatNormalizedTolerance)
+			Quat.Normalize();
+	}
+}
+
+bool FTransformerDragSample::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	enum : uint8
+	{
+		HasRotation	= 1 << 0,
+		HasScale	= 1 << 1,
+	};
+
+	Ar << DragId;
+	Ar << Sequence;
+
+	FVector location = DeltaTransform.GetLocation();
+	FQuat rotation = DeltaTransform.GetRotation();
+	FVector scale = DeltaTransform.GetScale3D();
+
+	uint8 flags = 0;
+	if (Ar.IsSaving())
+	{
+		if (!rotation.Equals(FQuat::Identity))
+			flags |= HasRotation;
+		if (!scale.IsNearlyZero())
+			flags |= HasScale;
+	}
+	Ar.SerializeBits(&flags, 2);
+
+	//Location to 1 decimal (same as FVector_NetQuantize10), Scale to 2 decimals
+	bOutSuccess = SerializePackedVector<10, 24>(location, Ar);
+
+	if (flags & HasRotation)
+		FTransformerNetQuantize::SerializeQuat(rotation, Ar);
+	else
+		rotation = FQuat::Identity;
+
+	if (flags & HasScale)
+		bOutSuccess &= SerializePackedVector<100, 24>(scale, Ar);
+	else
+		scale = FVector::ZeroVector;
+
+	if (Ar.IsLoading())
+		DeltaTransform = FTransform(rotation, location, scale);
+
+	return true;
+}
+
+int32 FTransformerDragSample::GetSerializedSize() const
+{
+	FNetBitWriter writer(512);
+	FTransformerDragSample sample(*this);
+	bool bSuccess = true;
+	sample.NetSerialize(writer, nullptr, bSuccess);
+	return (int32)writer.GetNumBytes();
+}
+
+bool FTransformerTransformCommit::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace TransformerNetQuantize;
+
+	bOutSuccess = true;
+
+	Ar << DragId;
+	uint8 streamed = bStreamed ? 1 : 0;
+	Ar.SerializeBits(&streamed, 1);
+	bStreamed = streamed != 0;
+
+	uint32 chunkIndex = ChunkIndex;
+	Ar.SerializeIntPacked(chunkIndex);
+	ChunkIndex = (uint16)chunkIndex;
+
+	uint32 count = Transforms.Num();
+	Ar.SerializeIntPacked(count);
+	if (Ar.IsLoading())
+	{
+		if (count > MaxCommitTransforms)
+		{
+			bOutSuccess = false;
+			Ar.SetError();
+			return false;
+		}
+		Transforms.SetNum(count);
+	}
+
+	for (FTransformerCommittedTransform& committed : Transforms)
+	{
+		//the Package Map sends the Component as its Network GUID
+		UObject* component = committed.Component;
+		if (Map)
+			bOutSuccess &= Map->SerializeObject(Ar, USceneComponent::StaticClass(), component);
+		committed.Component = Cast<USceneComponent>(component);
+
+		uint8 isInstance = (committed.InstanceIndex != INDEX_NONE) ? 1 : 0;
+		Ar.SerializeBits(&isInstance, 1);
+		if (isInstance)
+		{
+			uint32 instanceIndex = (uint32)committed.InstanceIndex;
+			Ar.SerializeIntPacked(instanceIndex);
+			committed.InstanceIndex = (int32)instanceIndex;
+		}
+		else
+			committed.InstanceIndex = INDEX_NONE;
+
+		FVector location = committed.Transform.GetLocation();
+		FQuat rotation = committed.Transform.GetRotation();
+		FVector scale = committed.Transform.GetScale3D();
+
+		bOutSuccess &= SerializePackedVector<10, 24>(location, Ar);
+		FTransformerNetQuantize::SerializeQuat(rotation, Ar);
+
+		uint8 unitScale = scale.Equals(FVector::OneVector) ? 1 : 0;
+		Ar.SerializeBits(&unitScale, 1);
+		if (unitScale)
+			scale = FVector::OneVector;
+		else
+			bOutSuccess &= SerializePackedVector<100, 24>(scale, Ar);
+
+		if (Ar.IsLoading())
+			committed.Transform = FTransform(rotation, location, scale);
+	}
+
+	return true;
+}
+
+void FTransformerTransformCommit::Quantize()
+{
+	//Components are not needed (and can't be sent without a Package Map), so only the Transforms go through
+	FNetBitWriter writer(nullptr, 8192);
+	bool bSuccess = true;
+	NetSerialize(writer, nullptr, bSuccess);
+
+	FNetBitReader reader(nullptr, writer.GetData(), writer.GetNumBits());
+	FTransformerTransformCommit quantized;
+	quantized.NetSerialize(reader, nullptr, bSuccess);
+
+	if (reader.IsError() || quantized.Transforms.Num() != Transforms.Num())
+		return;
+
+	for (int32 i = 0; i < Transforms.Num(); ++i)
+		Transforms[i].Transform = quantized.Transforms[i].Transform;
+}
+
+bool FTransformerSelectionDelta::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << BaseSequence;
+	Ar << Sequence;
+	Ar << SelectedCount;
+
+	bOutSuccess = TransformerNetQuantize::SerializeComponents(Ar, Map, Added, UnresolvedAdded)
+		&& TransformerNetQuantize::SerializeComponents(Ar, Map, Removed, UnresolvedRemoved);
+	return true;
+}
+
+bool FTransformerSelectionSnapshot::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Sequence;
+
+	uint32 chunkIndex = (uint32)ChunkIndex;
+	uint32 chunkCount = (uint32)ChunkCount;
+	Ar.SerializeIntPacked(chunkIndex);
+	Ar.SerializeIntPacked(chunkCount);
+	ChunkIndex = (int32)chunkIndex;
+	ChunkCount = (int32)chunkCount;
+
+	bOutSuccess = TransformerNetQuantize::SerializeComponents(Ar, Map, Components, UnresolvedComponents);
+	return true;
+}
+
+void FTransformerDragStreamSender::Begin()
+{
+	if (bStreaming) return;
+	bStreaming = true;
+	++DragId;
+	Sequence = 0;
+	LastSendTime = 0.0;
+}
+
+void FTransformerDragStreamSender::End()
+{
+	bStreaming = false;
+	WindowBytes = 0;
+	WindowStartTime = 0.0;
+	BytesPerSecond = 0.f;
+}
+
+void FTransformerDragStreamSender::AddSentBytes(int32 Bytes, double Time)
+{
+	if (WindowStartTime <= 0.0)
+		WindowStartTime = Time;
+
+	WindowBytes += Bytes;
+
+	const double elapsed = Time - WindowStartTime;
+	if (elapsed >= 1.0)
+	{
+		BytesPerSecond = (float)(WindowBytes / elapsed);
+		WindowBytes = 0;
+		WindowStartTime = Time;
+	}
+}
+
+bool FTransformerDragStreamReceiver::Receive(const FTransformerDragSample& Sample, double Time, float DefaultDuration)
+{
+	using namespace TransformerNetQuantize;
+
+	if (bActive)
+	{
+		//a Sample of the next Drag arriving before this Drag was Completed, or out of order
+		if (Sample.DragId != DragId || static_cast<int16>(Sample.Sequence - LatestSequence) <= 0)
+			return false;
+
+		//continue from what is being shown, so there are no jumps
+		PreviousDelta = Evaluate(Time);
+		Duration = FMath::Clamp((float)(Time - LatestTime), MinSampleDuration, MaxSampleDuration);
+	}
+	else
+	{
+		//late Sample of a Drag that was already Completed
+		if (bHasCompletedDrag && Sample.DragId == CompletedDragId)
+			return false;
+
+		bActive = true;
+		DragId = Sample.DragId;
+		ResetDeltas();
+		Duration = FMath::Clamp(DefaultDuration, MinSampleDuration, MaxSampleDuration);
+	}
+
+	LatestSequence = Sample.Sequence;
+	LatestDelta = Sample.DeltaTransform;
+	LatestTime = Time;
+	return true;
+}
+
+FTransform FTransformerDragStreamReceiver::Evaluate(double Time) const
+{
+	const float alpha = (Duration > 0.f) ? FMath::Clamp((float)((Time - LatestTime) / Duration), 0.f, 1.f) : 1.f;
+	return FTransform(FQuat::Slerp(PreviousDelta.GetRotation(), LatestDelta.GetRotation(), alpha)
+		, FMath::Lerp(PreviousDelta.GetLocation(), LatestDelta.GetLocation(), alpha)
+		, FMath::Lerp(PreviousDelta.GetScale3D(), LatestDelta.GetScale3D(), alpha));
+}
+
+void FTransformerDragStreamReceiver::Complete(uint8 InDragId)
+{
+	bActive = false;
+	bOwnsDragSession = false;
+	bHasCompletedDrag = true;
+	CompletedDragId = InDragId;
+	ResetDeltas();
+}
+
+void FTransformerDragStreamReceiver::ResetDeltas()
+{
+	PreviousDelta = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	LatestDelta = PreviousDelta;
+}
@@ -3,11 +3,21 @@
 
 #include "TransformerPawn.h"
 #include "Components/PrimitiveComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
 
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PackageMapClient.h"
 #include "Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+#include "TransformerMath.h"
+#include "SelectionIndex.h"
+#include "ConvexVolume.h"
+#include "NavigationSystem.h"
 
 /* Gizmos */
 #include "Gizmos/BaseGizmo.h"
@@ -18,6 +28,28 @@
 /* Interface */
 #include "FocusableObject.h"
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gizmo Spawns"), STAT_GizmoSpawns, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Transformed Components"), STAT_TransformedComponents, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Transformed Instances"), STAT_TransformedInstances, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Evaluate Transforms"), STAT_EvaluateTransforms, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Commit Transforms"), STAT_CommitTransforms, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Reconcile Overlaps"), STAT_ReconcileOverlaps, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Commit Backlog"), STAT_CommitBacklog, STATGROUP_RuntimeTransformer);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Commit Catch-up Latency (ms)"), STAT_CommitCatchUpLatency, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Update Drag Proxy"), STAT_UpdateDragProxy, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Marquee Selection"), STAT_MarqueeSelection, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Stale Async Traces"), STAT_StaleAsyncTraces, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Selection Trace"), STAT_SelectionTrace, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Two-Phase Pick Fallbacks"), STAT_TwoPhasePickFallbacks, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Drag Stream Bytes Per Second"), STAT_DragStreamBytesPerSecond, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dropped Drag Samples"), STAT_DroppedDragSamples, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Selection Entries Sent"), STAT_SelectionEntriesSent, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Selection Snapshots"), STAT_SelectionSnapshots, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Apply Selection Change"), STAT_ApplySelectionChange, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Missing Selection"), STAT_MissingSelection, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Missing Selection Resolved"), STAT_MissingSelectionResolved, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Deferred Navigation Dirty Areas"), STAT_DeferredNavigationDirtyAreas, STATGROUP_RuntimeTransformer);
+
 // Sets default values
 ATransformerPawn::ATransformerPawn()
 {
@@ -32,10 +64,19 @@ ATransformerPawn::ATransformerPawn()
 	RotationGizmoClass		= ARotationGizmo::StaticClass();
 	ScaleGizmoClass			= AScaleGizmo::StaticClass();
 
-	CloneReplicationCheckFrequency = 0.05f;
-	MinimumCloneReplicationTime = 0.01f;
-
-	bResyncSelection = false;
+	bStreamDragTransforms = false;
+	DragStreamRate = 20.f;
+	TransformCommitChunkSize = 128;
+	SelectionChunkSize = 512;
+	MissingSelectionRetryInterval = 0.5f;
+	MissingSelectionTimeout = 10.f;
+	SelectionSequence = 0;
+	ReceivedSelectionSequence = 0;
+	bAwaitingSelectionSnapshot = false;
+	bResolveMissingSelectionPending = false;
+
+	SelectionBatchDepth = 0;
+	bGizmoPlacementPending = false;
 	bReplicates = false;
 	bIgnoreNonReplicatedObjects = false;
 
@@ -48,15 +89,90 @@ ATransformerPawn::ATransformerPawn()
 	bTransformUFocusableObjects = true;
 	bRotateOnLocalAxis = false;
 	bForceMobility = false;
+	ParallelTransformThreshold = 512;
+	bDeferOverlapsWhileDragging = false;
+	bKinematicWhileDragging = true;
+	bDeferNavigationWhileDragging = true;
+	ProxyDragThreshold = 0;
+	CommitFrameBudgetMs = 0.f;
+	CommitRoundRobinShare = 0.25f;
+	bTickWhileIdle = true;
+	bAnalyticGizmoPicking = false;
+	bTwoPhasePicking = false;
+	bHoverGizmo = false;
+	DragProxyRoot = nullptr;
 	bToggleSelectedInMultiSelection = true;
+	bSelectInstances = false;
+	InstanceGizmoAnchor = nullptr;
 	bComponentBased = false;
+	bCoalesceSelectionEvents = false;
+
+	AsyncTraceTag = 0;
+	PendingTraceStage = EAsyncTraceStage::Local;
+	AsyncTraceDelegate.BindUObject(this, &ATransformerPawn::OnAsyncTraceDone);
 }
 
 void ATransformerPawn::GetLifetimeReplicatedProps(
 	TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	//Fill here if we need to replicate Properties. For now, nothing needs constant replication/check
+
+	//only compared when marked Dirty (@see ReplicateModeState), if WITH_PUSH_MODEL and net.IsPushModelEnabled=1
+	FDoRepLifetimeParams modeStateParams;
+	modeStateParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ATransformerPawn, ModeState, modeStateParams);
+}
+
+void ATransformerPawn::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//the Mode State starts as whatever the Server Pawn was set up with
+	if (HasAuthority())
+		ReplicateModeState();
+
+	//only Clients receive Selections with Components that haven't arrived yet
+	UWorld* world = GetWorld();
+	if (world && !HasAuthority())
+	{
+		ActorSpawnedHandle = world->AddOnActorSpawnedHandler(
+			FOnActorSpawned::FDelegate::CreateUObject(this, &ATransformerPawn::OnActorSpawned));
+	}
+}
+
+void ATransformerPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SelectionIndex.Reset();
+
+	if (ActorSpawnedHandle.IsValid())
+	{
+		if (UWorld* world = GetWorld())
+			world->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		ActorSpawnedHandle.Reset();
+	}
+
+	if (UWorld* world = GetWorld())
+		world->GetTimerManager().ClearTimer(MissingSelectionRetryHandle);
+
+	//Any Async Trace still in flight is now stale
+	++AsyncTraceTag;
+
+	//Release whatever the drag is holding (Navigation, Physics, Overlaps) if we're going away mid-drag,
+	// completing the Drag Stream for everyone else (@see SetDomain)
+	if (CurrentDomain != ETransformationDomain::TD_None)
+		ClearDomain();
+	else if (DragSession.bActive)
+		EndDragSession();
+
+	for (auto& pooledGizmo : GizmoPool)
+	{
+		if (pooledGizmo.Value.IsValid())
+			pooledGizmo.Value->Destroy();
+	}
+	GizmoPool.Empty();
+	Gizmo.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 UObject* ATransformerPawn::GetUFocusable(USceneComponent* Component) const
@@ -69,38 +185,128 @@ UObject* ATransformerPawn::GetUFocusable(USceneComponent* Component) const
 	return nullptr;
 }
 
+UObject* ATransformerPawn::GetSelectedFocusable(USceneComponent* Component) const
+{
+	if (const TWeakObjectPtr<UObject>* focusableObject = SelectedFocusables.Find(Component))
+		return focusableObject->Get();
+	return GetUFocusable(Component);
+}
+
 void ATransformerPawn::SetTransform(USceneComponent* Component, const FTransform& Transform)
 {
 	if (!Component) return;
-	if (UObject* focusableObject = GetUFocusable(Component))
+	SetTransform(Component, GetSelectedFocusable(Component), Transform);
+}
+
+void ATransformerPawn::SetTransform(USceneComponent* Component, UObject* focusableObject, const FTransform& Transform)
+{
+	if (!Component) return;
+	if (focusableObject)
 	{
-		IFocusableObject::Execute_OnNewTransformation(focusableObject, this, Component, Transform, bComponentBased);
+		//delivered all at once in FlushFocusableTransformations
+		if (BatchedFocusables.Contains(focusableObject))
+		{
+			FPendingFocusableTransformations& pending = PendingFocusableTransformations.FindOrAdd(focusableObject);
+			pending.Components.Add(Component);
+			pending.Transforms.Add(Transform);
+		}
+		else
+			IFocusableObject::Execute_OnNewTransformation(focusableObject, this, Component, Transform, bComponentBased);
+
 		if (bTransformUFocusableObjects)
-			Component->SetWorldTransform(Transform);
+			SetComponentWorldTransform(Component, Transform);
 	}
 	else
-		Component->SetWorldTransform(Transform);
+		SetComponentWorldTransform(Component, Transform);
+
+}
+
+void ATransformerPawn::SetComponentWorldTransform(USceneComponent* Component, const FTransform& Transform)
+{
+	//While dragging, Components are teleported so that their (kinematic) bodies do not push their neighbors around
+	const ETeleportType teleport = DragSession.bActive ? ETeleportType::TeleportPhysics : ETeleportType::None;
+
+	if (false == DragSession.bOverlapsDeferred)
+	{
+		Component->SetWorldTransform(Transform, false, nullptr, teleport);
+		return;
+	}
+
+	//Same as USceneComponent::SetWorldTransform, but setting the Relative Transform directly 
+	// instead of going through MoveComponent (which would update overlaps)
+	FTransform relativeTransform = Transform;
+	if (USceneComponent* parent = Component->GetAttachParent())
+	{
+		relativeTransform = Transform.GetRelativeTransform(parent->GetSocketTransform(Component->GetAttachSocketName()));
+		if (Component->IsUsingAbsoluteLocation())
+			relativeTransform.CopyTranslation(Transform);
+		if (Component->IsUsingAbsoluteRotation())
+			relativeTransform.CopyRotation(Transform);
+		if (Component->IsUsingAbsoluteScale())
+			relativeTransform.CopyScale3D(Transform);
+	}
 
+	Component->SetRelativeLocation_Direct(relativeTransform.GetLocation());
+	Component->SetRelativeRotation_Direct(relativeTransform.Rotator());
+	Component->SetRelativeScale3D_Direct(relativeTransform.GetScale3D());
+
+	//Bounds, Render Transform & Physics are still updated (for the whole subtree), but not the overlaps
+	Component->UpdateComponentToWorld(EUpdateTransformFlags::None, teleport);
 }
 
 void ATransformerPawn::Select(USceneComponent* Component, bool* bImplementsUFocusable)
 {
 	UObject* focusableObject = GetUFocusable(Component);
+	const bool bAlreadySelected = SelectedFocusables.Contains(Component);
+	SelectedFocusables.Add(Component, focusableObject);
 	if (focusableObject)
+	{
 		IFocusableObject::Execute_Focus(focusableObject, this, Component, bComponentBased);
+		if (!bAlreadySelected && IFocusableObject::Execute_WantsBatchedTransformations(focusableObject))
+			++BatchedFocusables.FindOrAdd(focusableObject);
+	}
 	if (bImplementsUFocusable)
 		*bImplementsUFocusable = !!focusableObject;
 }
 
 void ATransformerPawn::Deselect(USceneComponent* Component, bool* bImplementsUFocusable)
 {
-	UObject* focusableObject = GetUFocusable(Component);
+	UObject* focusableObject = nullptr;
+	TWeakObjectPtr<UObject> selectedFocusable;
+	if (SelectedFocusables.RemoveAndCopyValue(Component, selectedFocusable))
+	{
+		//the Focusable stops being Batched once none of its Components are Selected (found even if it was destroyed since)
+		int32* batchedCount = BatchedFocusables.Find(selectedFocusable);
+		if (batchedCount && --(*batchedCount) <= 0)
+			BatchedFocusables.Remove(selectedFocusable);
+		focusableObject = selectedFocusable.Get();
+	}
+	else
+		focusableObject = GetUFocusable(Component);
 	if (focusableObject)
 		IFocusableObject::Execute_Unfocus(focusableObject, this, Component, bComponentBased);
 	if (bImplementsUFocusable)
 		*bImplementsUFocusable = !!focusableObject;
 }
 
+void ATransformerPawn::FlushFocusableTransformations()
+{
+	for (auto& pending : PendingFocusableTransformations)
+	{
+		FPendingFocusableTransformations& transformations = pending.Value;
+		if (transformations.Components.Num() == 0) continue;
+
+		UObject* focusableObject = pending.Key.Get();
+		if (IsValid(focusableObject))
+			IFocusableObject::Execute_OnNewTransformations(focusableObject, this
+				, transformations.Components, transformations.Transforms, bComponentBased);
+
+		//keep the memory for the next frame
+		transformations.Components.Reset();
+		transformations.Transforms.Reset();
+	}
+}
+
 void ATransformerPawn::FilterHits(TArray<FHitResult>& outHits)
 {
 	//eliminate all outHits that have non-replicated objects
@@ -140,6 +346,8 @@ void ATransformerPawn::SetSpaceType(ESpaceType Type)
 {
 	CurrentSpaceType = Type;
 	SetGizmo();
+	if (Gizmo.IsValid())
+		Gizmo->RefreshGizmoSpace(CurrentSpaceType);
 }
 
 ETransformationDomain ATransformerPawn::GetCurrentDomain(bool& TransformInProgress) const
@@ -155,6 +363,53 @@ void ATransformerPawn::ClearDomain()
 	SetDomain(ETransformationDomain::TD_None);
 }
 
+void ATransformerPawn::CancelTransform()
+{
+	//the remote Pawns have to go back too, and their Drag Stream has to be completed
+	if (DragStreamSender.bStreaming)
+	{
+		ReplicateCancelTransform();
+		return;
+	}
+
+	if (DragSession.bActive)
+	{
+		//nothing was moved but the Proxy, so it just has to go away
+		if (DragSession.bProxyActive)
+			ReleaseDragProxy();
+
+		for (int32 i = 0; i < DragSession.Num(); ++i)
+		{
+			USceneComponent* component = DragSession.Components[i];
+			if (!IsValid(component)) continue;
+			const FTransform* originalTransform = DragSession.OriginalStartTransforms.Find(component);
+			SetTransform(component, DragSession.Focusables[i], originalTransform ? *originalTransform : DragSession.StartTransforms.GetTransform(i));
+			component->SetMobility(DragSession.StartMobilities[i]);
+		}
+
+		FlushFocusableTransformations();
+
+		//Start Transforms are already set, nothing else must be committed when the session ends
+		DragSession.CommittedVersions.Init(DragSession.TargetVersion, DragSession.Num());
+		DragSession.CommitBacklog = 0;
+
+		for (FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
+		{
+			batch.TargetTransforms = batch.StartTransforms;
+			for (int32 i = 0; i < batch.InstanceIndices.Num() && batch.OriginalStartTransforms.Num() > 0; ++i)
+			{
+				if (const FTransform* originalTransform = batch.OriginalStartTransforms.Find(batch.InstanceIndices[i]))
+					batch.TargetTransforms.SetTransform(i, *originalTransform);
+			}
+		}
+		CommitInstanceBatches();
+	}
+
+	//nothing has to be replicated anymore
+	ResetDeltaTransform(NetworkDeltaTransform);
+	ClearDomain();
+}
+
 bool ATransformerPawn::GetMouseStartEndPoints(float TraceDistance, FVector& outStartPoint, FVector& outEndPoint)
 {
 	if (APlayerController* PlayerController = Cast< APlayerController>(Controller))
@@ -170,6 +425,247 @@ bool ATransformerPawn::GetMouseStartEndPoints(float TraceDistance, FVector& outS
 	return false;
 }
 
+bool ATransformerPawn::TraceGizmoDomain(const FVector& StartLocation, const FVector& EndLocation
+	, const TArray<AActor*>& IgnoredActors)
+{
+	if (!Gizmo.IsValid() || IgnoredActors.Contains(Gizmo.Get()))
+		return false;
+	if (bAnalyticGizmoPicking)
+		return PickGizmoDomain(StartLocation, EndLocation);
+	if (bTwoPhasePicking)
+		return PickGizmoComponents(StartLocation, EndLocation);
+	return false;
+}
+
+bool ATransformerPawn::PickGizmoDomain(const FVector& StartLocation, const FVector& EndLocation)
+{
+	if (!Gizmo.IsValid()) return false;
+	return SetTracedGizmoDomain(Gizmo->TraceDomain(StartLocation, EndLocation));
+}
+
+bool ATransformerPawn::PickGizmoComponents(const FVector& StartLocation, const FVector& EndLocation)
+{
+	if (!Gizmo.IsValid()) return false;
+
+	FCollisionQueryParams CollisionQueryParams(SCENE_QUERY_STAT(GizmoComponentsTrace));
+	ETransformationDomain domain = ETransformationDomain::TD_None;
+	float closestTime = MAX_FLT;
+
+	TInlineComponentArray<UPrimitiveComponent*> gizmoComponents(Gizmo.Get());
+	for (UPrimitiveComponent* gizmoComponent : gizmoComponents)
+	{
+		FHitResult hitResult;
+		if (gizmoComponent->LineTraceComponent(hitResult, StartLocation, EndLocation, CollisionQueryParams)
+			&& hitResult.Time < closestTime)
+		{
+			//only the Components that have a Domain count (like in HandleTracedObjects)
+			const ETransformationDomain componentDomain = Gizmo->GetTransformationDomain(gizmoComponent);
+			if (componentDomain != ETransformationDomain::TD_None)
+			{
+				domain = componentDomain;
+				closestTime = hitResult.Time;
+			}
+		}
+	}
+	return SetTracedGizmoDomain(domain);
+}
+
+bool ATransformerPawn::SetTracedGizmoDomain(ETransformationDomain Domain)
+{
+	if (Domain == ETransformationDomain::TD_None)
+		return false;
+
+	//same as hitting the Gizmo in HandleTracedObjects
+	ClearDomain();
+	SetDomain(Domain);
+	Gizmo->SetTransformProgressState(true, CurrentDomain);
+	return true;
+}
+
+void ATransformerPawn::AddGizmosToIgnore(FCollisionQueryParams& outQueryParams) const
+{
+	if (Gizmo.IsValid())
+		outQueryParams.AddIgnoredActor(Gizmo.Get());
+	for (auto& pooledGizmo : GizmoPool)
+	{
+		if (pooledGizmo.Value.IsValid())
+			outQueryParams.AddIgnoredActor(pooledGizmo.Value.Get());
+	}
+}
+
+USceneComponent* ATransformerPawn::GetHitSelectionComponent(const FHitResult& HitResult, bool& bOutInstanceHit) const
+{
+	bOutInstanceHit = false;
+
+	//Gizmos of other Pawns are not ignored by the Trace
+	if (Cast<ABaseGizmo>(HitResult.Actor))
+		return nullptr;
+
+	//same Component that HandleTracedObjects would Select
+	UInstancedStaticMeshComponent* instancedMesh = Cast<UInstancedStaticMeshComponent>(HitResult.GetComponent());
+	if (bSelectInstances && instancedMesh && HitResult.Item != INDEX_NONE)
+	{
+		bOutInstanceHit = true;
+		return instancedMesh->IsValidInstance(HitResult.Item) ? instancedMesh : nullptr;
+	}
+	if (bComponentBased)
+		return HitResult.GetComponent();
+
+	AActor* owner = HitResult.GetActor();
+	return owner ? owner->GetRootComponent() : nullptr;
+}
+
+bool ATransformerPawn::SelectFirstSelectableHit(const TArray<FHitResult>& HitResults, bool bAppendToList)
+{
+	ClearDomain();
+
+	for (const FHitResult& hitResult : HitResults)
+	{
+		bool bInstanceHit;
+		USceneComponent* component = GetHitSelectionComponent(hitResult, bInstanceHit);
+		if (!component || !ShouldSelect(hitResult.GetActor(), component))
+			continue;
+
+		//same as SelectInstance / SelectComponent / SelectActor, without asking ShouldSelect again
+		FScopedSelectionBatch selectionBatch(this);
+		if (false == bAppendToList)
+			DeselectAll();
+		if (bInstanceHit)
+			AddInstance_Internal(FSelectedInstance(CastChecked<UInstancedStaticMeshComponent>(component), hitResult.Item));
+		else
+			AddComponent_Internal(component);
+		UpdateGizmoPlacement();
+		return true;
+	}
+	return false;
+}
+
+bool ATransformerPawn::HandleTracedHit(const FHitResult& HitResult, bool bAppendToList)
+{
+	TArray<FHitResult> hitResults;
+	hitResults.Add(HitResult);
+	FilterHits(hitResults);
+
+	if (!SelectFirstSelectableHit(hitResults, bAppendToList))
+	{
+		INC_DWORD_STAT(STAT_TwoPhasePickFallbacks);
+		return false;
+	}
+	return true;
+}
+
+bool ATransformerPawn::StartAsyncTrace(const FTransformerTraceQuery& Query
+	, const TArray<AActor*>& IgnoredActors, EAsyncTraceStage Stage)
+{
+	UWorld* world = GetWorld();
+	if (!world) return false;
+
+	//a new Trace makes whatever is still in flight stale
+	++AsyncTraceTag;
+	PendingTraceQuery = Query;
+	PendingTraceStage = Stage;
+
+	//the closed-form Gizmo Test is cheap enough to not wait for
+	if (TraceGizmoDomain(Query.StartLocation, Query.EndLocation, IgnoredActors))
+	{
+		FinishAsyncTrace(true);
+		return true;
+	}
+
+	FCollisionQueryParams CollisionQueryParams;
+	CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+
+	switch (Query.Type)
+	{
+	case ETraceQueryType::QT_ObjectTypes:
+	{
+		FCollisionObjectQueryParams CollisionObjectQueryParams;
+		for (auto& cc : Query.CollisionChannels)
+			CollisionObjectQueryParams.AddObjectTypesToQuery(cc);
+
+		world->AsyncLineTraceByObjectType(EAsyncTraceType::Multi, Query.StartLocation, Query.EndLocation
+			, CollisionObjectQueryParams, CollisionQueryParams, &AsyncTraceDelegate, AsyncTraceTag);
+		break;
+	}
+	case ETraceQueryType::QT_Channel:
+		world->AsyncLineTraceByChannel(EAsyncTraceType::Multi, Query.StartLocation, Query.EndLocation
+			, Query.TraceChannel, CollisionQueryParams, FCollisionResponseParams::DefaultResponseParam
+			, &AsyncTraceDelegate, AsyncTraceTag);
+		break;
+	case ETraceQueryType::QT_Profile:
+		world->AsyncLineTraceByProfile(EAsyncTraceType::Multi, Query.StartLocation, Query.EndLocation
+			, Query.ProfileName, CollisionQueryParams, &AsyncTraceDelegate, AsyncTraceTag);
+		break;
+	}
+	return true;
+}
+
+void ATransformerPawn::OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	//a newer Trace was issued after this one
+	if (TraceDatum.UserData != AsyncTraceTag)
+	{
+		INC_DWORD_STAT(STAT_StaleAsyncTraces);
+		return;
+	}
+
+	//the Multi Line Traces succeed when there is a Blocking Hit
+	bool bTraceSuccessful = false;
+	for (auto& hitResult : TraceDatum.OutHits)
+	{
+		if (hitResult.bBlockingHit)
+		{
+			bTraceSuccessful = true;
+			break;
+		}
+	}
+
+	if (bTraceSuccessful)
+	{
+		//Components could have been destroyed since the Trace was issued
+		TraceDatum.OutHits.RemoveAll([](const FHitResult& hitResult) { return !hitResult.GetComponent(); });
+		FilterHits(TraceDatum.OutHits);
+		bTraceSuccessful = HandleTracedObjects(TraceDatum.OutHits, PendingTraceQuery.bAppendToList);
+	}
+
+	FinishAsyncTrace(bTraceSuccessful);
+}
+
+void ATransformerPawn::FinishAsyncTrace(bool bTraceSuccessful)
+{
+	const bool bAppendToList = PendingTraceQuery.bAppendToList;
+	switch (PendingTraceStage)
+	{
+	case EAsyncTraceStage::Local:
+		if (!bTraceSuccessful && !bAppendToList)
+			ServerDeselectAll(false);
+		break;
+	case EAsyncTraceStage::Replicated:
+		//Server
+		if (GetLocalRole() == ROLE_Authority)
+			ReplicateServerTraceResults(bTraceSuccessful, bAppendToList);
+		//Client
+		else if (!bTraceSuccessful && !bAppendToList)
+			ServerDeselectAll(false);
+		// If a Local Trace was on a Gizmo, just tell the Server that we 
+		// have hit our Gizmo and just change the Domain there.
+		// Else, do the Server Trace
+		else if (CurrentDomain == ETransformationDomain::TD_None)
+			ServerAsyncTrace(PendingTraceQuery);
+		else
+			ServerSetDomain(CurrentDomain);
+		break;
+	case EAsyncTraceStage::Server:
+		if (!bTraceSuccessful && !bAppendToList)
+			DeselectAll(false);
+		ReplicateModeState();
+		ReplicateSelection();
+		break;
+	}
+
+	OnAsyncTraceCompleted(bTraceSuccessful);
+}
+
 UClass* ATransformerPawn::GetGizmoClass(ETransformationType TransformationType) const /* private */
 {
 	//Assign correct Gizmo Class depending on given Transformation
@@ -188,13 +684,47 @@ void ATransformerPawn::ResetDeltaTransform(FTransform& Transform)
 	Transform.SetScale3D(FVector::ZeroVector);
 }
 
+void ATransformerPawn::AccumulateDeltaTransform(FTransform& outAccumulatedTransform, const FTransform& DeltaTransform)
+{
+	outAccumulatedTransform = FTransform(
+		DeltaTransform.GetRotation() * outAccumulatedTransform.GetRotation(),
+		DeltaTransform.GetLocation() + outAccumulatedTransform.GetLocation(),
+		DeltaTransform.GetScale3D() + outAccumulatedTransform.GetScale3D());
+}
+
 void ATransformerPawn::SetDomain(ETransformationDomain Domain)
 {
+	const ETransformationDomain PreviousDomain = CurrentDomain;
 	CurrentDomain = Domain;
 
+	//Snapshot the Selection when a Transform starts, and release it when it finishes
+	if (PreviousDomain == ETransformationDomain::TD_None && CurrentDomain != ETransformationDomain::TD_None)
+		BeginDragSession();
+	else if (CurrentDomain == ETransformationDomain::TD_None)
+	{
+		//a Streamed Drag that ends without ReplicateFinishTransform (e.g. the Domain cleared locally) is still completed everywhere,
+		// so that the remote Pawns stop receiving it
+		const bool bStreamed = DragStreamSender.bStreaming;
+		TArray<FTransformerCommittedTransform> committedTransforms;
+		if (bStreamed)
+			GatherCommittedTransforms(committedTransforms);
+
+		EndDragSession();
+
+		if (bStreamed)
+		{
+			EndDragStream();
+			ServerClearDomain();
+			ReplicateTransformCommit(committedTransforms, true);
+			ResetDeltaTransform(NetworkDeltaTransform);
+		}
+	}
+
 	if (Gizmo.IsValid())
 		Gizmo->SetTransformProgressState(CurrentDomain != ETransformationDomain::TD_None
 			, CurrentDomain);
+
+	UpdateTickEnabled();
 }
 
 bool ATransformerPawn::MouseTraceByObjectTypes(float TraceDistance
@@ -249,196 +779,1241 @@ bool ATransformerPawn::MouseTraceByProfile(float TraceDistance
 	return bTraceSuccessful;
 }
 
-bool ATransformerPawn::TraceByObjectTypes(const FVector& StartLocation
-	, const FVector& EndLocation
-	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
-	, TArray<AActor*> IgnoredActors
-	, bool bAppendToList)
+bool ATransformerPawn::MouseTraceBySelectionIndex(float TraceDistance, bool bAppendToList)
 {
-	if (UWorld* world = GetWorld())
+	FVector start, end;
+	bool bTraceSuccessful = false;
+	if (GetMouseStartEndPoints(TraceDistance, start, end))
 	{
-		FCollisionObjectQueryParams CollisionObjectQueryParams;
-		FCollisionQueryParams CollisionQueryParams;
+		bTraceSuccessful = TraceBySelectionIndex(start, end, bAppendToList);
+		if (!bTraceSuccessful && !bAppendToList)
+			ServerDeselectAll(false);
+	}
+	return bTraceSuccessful;
+}
 
-		//Add All Given Collisions to the Array
-		for (auto& cc : CollisionChannels)
-			CollisionObjectQueryParams.AddObjectTypesToQuery(cc);
+bool ATransformerPawn::AsyncMouseTraceByObjectTypes(float TraceDistance
+	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+	, TArray<AActor*> IgnoredActors, bool bAppendToList)
+{
+	FTransformerTraceQuery query;
+	if (!GetMouseStartEndPoints(TraceDistance, query.StartLocation, query.EndLocation))
+		return false;
 
-		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+	query.Type = ETraceQueryType::QT_ObjectTypes;
+	query.CollisionChannels = CollisionChannels;
+	query.bAppendToList = bAppendToList;
+	return StartAsyncTrace(query, IgnoredActors, EAsyncTraceStage::Local);
+}
 
-		TArray<FHitResult> OutHits;
-		if (world->LineTraceMultiByObjectType(OutHits, StartLocation, EndLocation
-			, CollisionObjectQueryParams, CollisionQueryParams))
-		{
-			FilterHits(OutHits);
-			return HandleTracedObjects(OutHits, bAppendToList);
-		}
-	}
-	return false;
+bool ATransformerPawn::AsyncMouseTraceByChannel(float TraceDistance
+	, TEnumAsByte<ECollisionChannel> TraceChannel, TArray<AActor*> IgnoredActors
+	, bool bAppendToList)
+{
+	FTransformerTraceQuery query;
+	if (!GetMouseStartEndPoints(TraceDistance, query.StartLocation, query.EndLocation))
+		return false;
+
+	query.Type = ETraceQueryType::QT_Channel;
+	query.TraceChannel = TraceChannel;
+	query.bAppendToList = bAppendToList;
+	return StartAsyncTrace(query, IgnoredActors, EAsyncTraceStage::Local);
 }
 
-bool ATransformerPawn::TraceByChannel(const FVector& StartLocation
-	, const FVector& EndLocation
-	, TEnumAsByte<ECollisionChannel> TraceChannel
+bool ATransformerPawn::AsyncMouseTraceByProfile(float TraceDistance
+	, const FName& ProfileName
 	, TArray<AActor*> IgnoredActors
 	, bool bAppendToList)
 {
-	if (UWorld* world = GetWorld())
-	{
-		FCollisionQueryParams CollisionQueryParams;
-		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+	FTransformerTraceQuery query;
+	if (!GetMouseStartEndPoints(TraceDistance, query.StartLocation, query.EndLocation))
+		return false;
 
-		TArray<FHitResult> OutHits;
-		if (world->LineTraceMultiByChannel(OutHits, StartLocation, EndLocation
-			, TraceChannel, CollisionQueryParams))
+	query.Type = ETraceQueryType::QT_Profile;
+	query.ProfileName = ProfileName;
+	query.bAppendToList = bAppendToList;
+	return StartAsyncTrace(query, IgnoredActors, EAsyncTraceStage::Local);
+}
+
+bool ATransformerPawn::TraceBySelectionIndex(const FVector& StartLocation
+	, const FVector& EndLocation
+	, bool bAppendToList)
+{
+	//no Physics involved here, so the Gizmo is always picked in closed form
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
+	TArray<FSelectionIndexHit> indexHits;
+	SelectionIndex.Raycast(StartLocation, EndLocation, indexHits);
+	if (indexHits.Num() == 0) return false;
+
+	//same Hits a Multi Line Trace would give
+	const FVector traceNormal = (StartLocation - EndLocation).GetSafeNormal();
+	const float traceLength = FVector::Dist(StartLocation, EndLocation);
+
+	TArray<FHitResult> OutHits;
+	OutHits.Reserve(indexHits.Num());
+	for (const FSelectionIndexHit& indexHit : indexHits)
+	{
+		FHitResult& hitResult = OutHits.Emplace_GetRef(indexHit.Component->GetOwner(), indexHit.Component
+			, FMath::Lerp(StartLocation, EndLocation, indexHit.Time), traceNormal);
+		hitResult.Time = indexHit.Time;
+		hitResult.Distance = indexHit.Time * traceLength;
+		hitResult.TraceStart = StartLocation;
+		hitResult.TraceEnd = EndLocation;
+	}
+
+	FilterHits(OutHits);
+	return HandleTracedObjects(OutHits, bAppendToList);
+}
+
+bool ATransformerPawn::GetMarqueeFrustumPlanes(const FVector2D& ScreenStart, const FVector2D& ScreenEnd
+	, float TraceDistance, TArray<FPlane>& outFrustumPlanes)
+{
+	APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	if (!PlayerController) return false;
+
+	const FVector2D screenMin(FMath::Min(ScreenStart.X, ScreenEnd.X), FMath::Min(ScreenStart.Y, ScreenEnd.Y));
+	const FVector2D screenMax(FMath::Max(ScreenStart.X, ScreenEnd.X), FMath::Max(ScreenStart.Y, ScreenEnd.Y));
+
+	//a Rectangle without area gives a degenerate Frustum
+	if (screenMax.X - screenMin.X < 1.f || screenMax.Y - screenMin.Y < 1.f) return false;
+
+	//Corners in order around the Rectangle, so that each pair of consecutive Corners is a side
+	const FVector2D screenCorners[4] = { screenMin, FVector2D(screenMax.X, screenMin.Y)
+		, screenMax, FVector2D(screenMin.X, screenMax.Y) };
+
+	FVector locations[4], directions[4];
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (!PlayerController->DeprojectScreenPositionToWorld(screenCorners[i].X, screenCorners[i].Y
+			, locations[i], directions[i]))
+			return false;
+	}
+
+	const FVector centerLocation = (locations[0] + locations[1] + locations[2] + locations[3]) * 0.25f;
+	const FVector centerDirection = (directions[0] + directions[1] + directions[2] + directions[3]).GetSafeNormal();
+
+	//used to have every Plane Normal pointing outwards
+	const FVector insidePoint = centerLocation + centerDirection * (TraceDistance * 0.5f);
+
+	outFrustumPlanes.Reset(6);
+	for (int32 i = 0; i < 4; ++i)
+	{
+		//each side contains the Rays of both of its Corners (works for Orthographic Views too, where the Rays are parallel)
+		const int32 next = (i + 1) % 4;
+		const FVector normal = FVector::CrossProduct(locations[next] + directions[next] - locations[i], directions[i]).GetSafeNormal();
+		if (normal.IsZero()) return false;
+
+		FPlane plane(locations[i], normal);
+		if (plane.PlaneDot(insidePoint) > 0.f)
+			plane = plane.Flip();
+		outFrustumPlanes.Add(plane);
+	}
+
+	//Near Plane, as the sides of an Orthographic Frustum do not meet at the Camera and would reach behind it
+	outFrustumPlanes.Add(FPlane(centerLocation, -centerDirection));
+
+	//Far Plane
+	outFrustumPlanes.Add(FPlane(centerLocation + centerDirection * TraceDistance, centerDirection));
+	return true;
+}
+
+bool ATransformerPawn::MarqueeSelect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd
+	, float TraceDistance, EMarqueeSelectionMode Mode)
+{
+	TArray<FPlane> frustumPlanes;
+	if (!GetMarqueeFrustumPlanes(ScreenStart, ScreenEnd, TraceDistance, frustumPlanes))
+		return false;
+
+	SelectInFrustum(frustumPlanes, Mode);
+	return true;
+}
+
+void ATransformerPawn::SelectInFrustum(const TArray<FPlane>& FrustumPlanes, EMarqueeSelectionMode Mode)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MarqueeSelection);
+
+	FConvexVolume frustum;
+	frustum.Planes = FrustumPlanes;
+	frustum.Init();
+
+	TArray<UPrimitiveComponent*> foundComponents;
+	SelectionIndex.QueryConvexVolume(frustum, foundComponents);
+
+	//What a Trace on each of the Components found would select (i.e. the Root Component, if Actor Based)
+	// ShouldSelect is only asked when selecting, anything can be deselected
+	const bool bSelecting = (Mode == EMarqueeSelectionMode::MS_Replace || Mode == EMarqueeSelectionMode::MS_Add);
+
+	TArray<USceneComponent*> componentsInFrustum;
+	TSet<USceneComponent*> componentsInFrustumSet;
+	componentsInFrustum.Reserve(foundComponents.Num());
+	componentsInFrustumSet.Reserve(foundComponents.Num());
+	for (UPrimitiveComponent* primitiveComponent : foundComponents)
+	{
+		AActor* owner = primitiveComponent->GetOwner();
+		USceneComponent* component = bComponentBased ? primitiveComponent
+			: (owner ? owner->GetRootComponent() : nullptr);
+		if (!component || componentsInFrustumSet.Contains(component)) continue;
+		if (bSelecting && !ShouldSelect(owner, component)) continue;
+
+		componentsInFrustumSet.Add(component);
+		componentsInFrustum.Add(component);
+	}
+
+	FScopedSelectionBatch selectionBatch(this);
+
+	if (Mode == EMarqueeSelectionMode::MS_Replace)
+		DeselectAll();
+
+	switch (Mode)
+	{
+	case EMarqueeSelectionMode::MS_Replace:
+	case EMarqueeSelectionMode::MS_Add:
+		for (USceneComponent* component : componentsInFrustum)
+		{
+			//Marquee never toggles, so what's already selected stays selected
+			if (!SelectedComponents.Contains(component))
+				AddComponent_Internal(component);
+		}
+		break;
+	case EMarqueeSelectionMode::MS_Subtract:
+		for (USceneComponent* component : componentsInFrustum)
+		{
+			if (SelectedComponents.Contains(component))
+				DeselectComponent_Internal(component);
+		}
+		break;
+	case EMarqueeSelectionMode::MS_Intersect:
+	{
+		const TArray<USceneComponent*> selectedComponents = SelectedComponents.GetArray();
+		for (USceneComponent* component : selectedComponents)
+		{
+			if (!componentsInFrustumSet.Contains(component))
+				DeselectComponent_Internal(component);
+		}
+		break;
+	}
+	}
+
+	UpdateGizmoPlacement();
+}
+
+bool ATransformerPawn::TraceByObjectTypes(const FVector& StartLocation
+	, const FVector& EndLocation
+	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+	, TArray<AActor*> IgnoredActors
+	, bool bAppendToList)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SelectionTrace);
+
+	if (TraceGizmoDomain(StartLocation, EndLocation, IgnoredActors))
+		return true;
+
+	if (UWorld* world = GetWorld())
+	{
+		FCollisionObjectQueryParams CollisionObjectQueryParams;
+		FCollisionQueryParams CollisionQueryParams;
+
+		//Add All Given Collisions to the Array
+		for (auto& cc : CollisionChannels)
+			CollisionObjectQueryParams.AddObjectTypesToQuery(cc);
+
+		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+
+		if (bTwoPhasePicking)
+		{
+			AddGizmosToIgnore(CollisionQueryParams);
+
+			FHitResult hitResult;
+			if (!world->LineTraceSingleByObjectType(hitResult, StartLocation, EndLocation
+				, CollisionObjectQueryParams, CollisionQueryParams))
+				return false;
+			if (HandleTracedHit(hitResult, bAppendToList))
+				return true;
+		}
+
+		TArray<FHitResult> OutHits;
+		if (world->LineTraceMultiByObjectType(OutHits, StartLocation, EndLocation
+			, CollisionObjectQueryParams, CollisionQueryParams))
 		{
 			FilterHits(OutHits);
+			if (bTwoPhasePicking)
+				return SelectFirstSelectableHit(OutHits, bAppendToList);
 			return HandleTracedObjects(OutHits, bAppendToList);
 		}
 	}
-	return false;
+	return false;
+}
+
+bool ATransformerPawn::TraceByChannel(const FVector& StartLocation
+	, const FVector& EndLocation
+	, TEnumAsByte<ECollisionChannel> TraceChannel
+	, TArray<AActor*> IgnoredActors
+	, bool bAppendToList)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SelectionTrace);
+
+	if (TraceGizmoDomain(StartLocation, EndLocation, IgnoredActors))
+		return true;
+
+	if (UWorld* world = GetWorld())
+	{
+		FCollisionQueryParams CollisionQueryParams;
+		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+
+		if (bTwoPhasePicking)
+		{
+			AddGizmosToIgnore(CollisionQueryParams);
+
+			FHitResult hitResult;
+			if (!world->LineTraceSingleByChannel(hitResult, StartLocation, EndLocation
+				, TraceChannel, CollisionQueryParams))
+				return false;
+			if (HandleTracedHit(hitResult, bAppendToList))
+				return true;
+		}
+
+		TArray<FHitResult> OutHits;
+		if (world->LineTraceMultiByChannel(OutHits, StartLocation, EndLocation
+			, TraceChannel, CollisionQueryParams))
+		{
+			FilterHits(OutHits);
+			if (bTwoPhasePicking)
+				return SelectFirstSelectableHit(OutHits, bAppendToList);
+			return HandleTracedObjects(OutHits, bAppendToList);
+		}
+	}
+	return false;
+}
+
+bool ATransformerPawn::TraceByProfile(const FVector& StartLocation
+	, const FVector& EndLocation
+	, const FName& ProfileName, TArray<AActor*> IgnoredActors
+	, bool bAppendToList)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SelectionTrace);
+
+	if (TraceGizmoDomain(StartLocation, EndLocation, IgnoredActors))
+		return true;
+
+	if (UWorld* world = GetWorld())
+	{
+		FCollisionQueryParams CollisionQueryParams;
+		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+
+		if (bTwoPhasePicking)
+		{
+			AddGizmosToIgnore(CollisionQueryParams);
+
+			FHitResult hitResult;
+			if (!world->LineTraceSingleByProfile(hitResult, StartLocation, EndLocation
+				, ProfileName, CollisionQueryParams))
+				return false;
+			if (HandleTracedHit(hitResult, bAppendToList))
+				return true;
+		}
+
+		TArray<FHitResult> OutHits;
+		if (world->LineTraceMultiByProfile(OutHits, StartLocation, EndLocation
+			, ProfileName, CollisionQueryParams))
+		{
+			FilterHits(OutHits);
+			if (bTwoPhasePicking)
+				return SelectFirstSelectableHit(OutHits, bAppendToList);
+			return HandleTracedObjects(OutHits, bAppendToList);
+		}
+	}
+	return false;
+}
+
+#include "Kismet/GameplayStatics.h"
+void ATransformerPawn::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (!Gizmo.IsValid())
+	{
+		UpdateTickEnabled();
+		return;
+	}
+
+	//Idle: only the Gizmo Scene follows the Camera (skipped by the Gizmo if the Camera did not change)
+	if (!bTickWhileIdle && !bHoverGizmo && !IsTickBusy())
+	{
+		ScaleGizmoToLocalView();
+		return;
+	}
+
+	if (APlayerController* PlayerController = Cast< APlayerController>(Controller))
+	{
+		FVector worldLocation, worldDirection;
+		if (PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
+		{
+			if (PlayerController->DeprojectMousePositionToWorld(worldLocation, worldDirection))
+			{
+				FTransform deltaTransform = UpdateTransform(PlayerController->PlayerCameraManager->GetActorForwardVector()
+					, worldLocation, worldDirection);
+
+				AccumulateDeltaTransform(NetworkDeltaTransform, deltaTransform);
+
+				if (bStreamDragTransforms)
+					StreamDragSample();
+
+				if (bHoverGizmo && CurrentDomain == ETransformationDomain::TD_None)
+					Gizmo->UpdateHoveredDomain(worldLocation, worldLocation + worldDirection * HALF_WORLD_MAX);
+			}
+				
+		}			
+	}
+
+	UpdateDragStreamReceiver();
+
+	ScaleGizmoToLocalView();
+
+	//Components left behind by the Commit Frame Budget catch up even if the Delta does not change
+	if (DragSession.bActive && !DragSession.bProxyActive && DragSession.CommitBacklog > 0
+		&& DragSession.LastBudgetedCommitFrame != GFrameCounter)
+		CommitDragSession(true);
+
+	UpdateTickEnabled();
+}
+
+void ATransformerPawn::ScaleGizmoToLocalView()
+{
+	if (!Gizmo.IsValid()) return;
+
+	//Only consider Local View. Skipped by the Gizmo if neither the Camera nor the Gizmo moved
+	if (APlayerController* LocalPlayerController = UGameplayStatics::GetPlayerController(this, 0))
+	{
+		if (LocalPlayerController->PlayerCameraManager)
+		{
+			Gizmo->ScaleGizmoScene(LocalPlayerController->PlayerCameraManager->GetCameraLocation()
+				, LocalPlayerController->PlayerCameraManager->GetActorForwardVector()
+				, LocalPlayerController->PlayerCameraManager->GetFOVAngle());
+		}
+	}
+}
+
+void ATransformerPawn::StreamDragSample()
+{
+	if (CurrentDomain == ETransformationDomain::TD_None) return;
+
+	DragStreamSender.Begin();
+
+	const double now = FPlatformTime::Seconds();
+	if (now - DragStreamSender.LastSendTime < 1.0 / FMath::Max(DragStreamRate, 1.f))
+		return;
+	DragStreamSender.LastSendTime = now;
+
+	const FTransformerDragSample sample(DragStreamSender.DragId, ++DragStreamSender.Sequence, NetworkDeltaTransform);
+	DragStreamSender.AddSentBytes(sample.GetSerializedSize(), now);
+	SET_DWORD_STAT(STAT_DragStreamBytesPerSecond, FMath::RoundToInt(DragStreamSender.BytesPerSecond));
+
+	ServerStreamDragSample(sample);
+}
+
+void ATransformerPawn::UpdateDragStreamReceiver()
+{
+	if (!DragStreamReceiver.bActive || !DragSession.bActive) return;
+
+	//nothing to do once the latest Sample has been reached, until the next one arrives
+	const FTransform deltaTransform = DragStreamReceiver.Evaluate(FPlatformTime::Seconds());
+	if (deltaTransform.Equals(DragSession.TotalDeltaTransform, 0.f)) return;
+
+	DragSession.TotalDeltaTransform = deltaTransform;
+	ApplyDragSession();
+}
+
+bool ATransformerPawn::IsTickBusy() const
+{
+	return CurrentDomain != ETransformationDomain::TD_None
+		|| (DragSession.bActive && DragSession.CommitBacklog > 0)
+		|| DragStreamReceiver.bActive;
+}
+
+void ATransformerPawn::UpdateTickEnabled()
+{
+	//an enabled Gizmo keeps the Tick on, so that its Scene is rescaled when the Camera moves or zooms
+	SetActorTickEnabled(bTickWhileIdle || IsTickBusy() || Gizmo.IsValid());
+}
+
+void ATransformerPawn::SetTickWhileIdle(bool bInTickWhileIdle)
+{
+	bTickWhileIdle = bInTickWhileIdle;
+	if (Gizmo.IsValid())
+		Gizmo->SetTickWhileIdle(bTickWhileIdle);
+	UpdateTickEnabled();
+}
+
+FTransform ATransformerPawn::UpdateTransform(const FVector& LookingVector
+	, const FVector& RayOrigin
+	, const FVector& RayDirection)
+{
+	FTransform deltaTransform;
+	deltaTransform.SetScale3D(FVector::ZeroVector);
+
+	if (!Gizmo.IsValid() || CurrentDomain == ETransformationDomain::TD_None) 
+		return deltaTransform;
+
+	FVector rayEnd = RayOrigin + 1'000'000'00 * RayDirection;
+
+	FTransform calcDeltaTransform = Gizmo->GetDeltaTransform(LookingVector, RayOrigin, rayEnd, CurrentDomain);
+
+	//The delta transform we are actually going to apply (same if there is no Snapping taking place)
+	deltaTransform = calcDeltaTransform;
+
+	/* SNAPPING LOGIC */
+	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
+	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+
+	if (snappingEnabled && *snappingEnabled && snappingValue)
+			deltaTransform = Gizmo->GetSnappedTransform(AccumulatedDeltaTransform
+				, calcDeltaTransform, CurrentDomain, *snappingValue);
+				//GetSnapped Transform Modifies Accumulated Delta Transform by how much Snapping Occurred
+	
+	ApplyDeltaTransform(deltaTransform);
+	return deltaTransform;
+}
+
+void ATransformerPawn::ApplyDeltaTransform(const FTransform& DeltaTransform)
+{
+	//No Transform in Progress (e.g. a replicated Delta). Take a snapshot just for this delta
+	const bool bSingleDeltaSession = !DragSession.bActive;
+	if (bSingleDeltaSession)
+		BeginDragSession(true);
+
+	AccumulateDeltaTransform(DragSession.TotalDeltaTransform, DeltaTransform);
+	ApplyDragSession();
+
+	if (bSingleDeltaSession)
+		EndDragSession();
+}
+
+void ATransformerPawn::BeginDragSession(bool bSingleDelta)
+{
+	//a retake of the Snapshot mid-drag keeps where the Components were before the drag started, so that it can still be Cancelled
+	TMap<USceneComponent*, TPair<FTransform, TEnumAsByte<EComponentMobility::Type>>> originalStates;
+	TMap<UInstancedStaticMeshComponent*, TMap<int32, FTransform>> originalInstanceTransforms;
+	if (DragSession.bActive)
+	{
+		for (int32 i = 0; i < DragSession.Num(); ++i)
+		{
+			USceneComponent* component = DragSession.Components[i];
+			const FTransform* originalTransform = DragSession.OriginalStartTransforms.Find(component);
+			originalStates.Add(component, TPair<FTransform, TEnumAsByte<EComponentMobility::Type>>(
+				originalTransform ? *originalTransform : DragSession.StartTransforms.GetTransform(i), DragSession.StartMobilities[i]));
+		}
+
+		for (const FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
+		{
+			TMap<int32, FTransform>& originalTransforms = originalInstanceTransforms.Add(batch.InstancedMesh);
+			for (int32 i = 0; i < batch.InstanceIndices.Num(); ++i)
+			{
+				const FTransform* originalTransform = batch.OriginalStartTransforms.Find(batch.InstanceIndices[i]);
+				originalTransforms.Add(batch.InstanceIndices[i], originalTransform ? *originalTransform : batch.StartTransforms.GetTransform(i));
+			}
+		}
+
+		//and must not lose the overlaps deferred nor the physics state stored so far
+		EndDragSession();
+	}
+
+	DragSession.Reset();
+	DragSession.bActive = true;
+	DragSession.bSingleDelta = bSingleDelta;
+	DragSession.bOverlapsDeferred = bDeferOverlapsWhileDragging;
+
+	if (Gizmo.IsValid())
+		DragSession.GizmoStartLocation = Gizmo->GetActorLocation();
+
+	//Only the Roots are transformed: Selected Descendants follow them through Attachment,
+	// and transforming them too would update their subtree twice
+	const TArray<USceneComponent*>& selectedRoots = SelectedRoots.GetArray();
+
+	//Roots are kept up to date on Select/Deselect only, so Mobility or Settings changed since then are checked here:
+	// Roots now covered by a moving Ancestor are skipped, and Roots that won't move don't carry their Selected Descendants
+	TArray<USceneComponent*> sessionComponents;
+	sessionComponents.Reserve(selectedRoots.Num());
+	TSet<USceneComponent*> uncoveredDescendants;
+	TArray<USceneComponent*> descendants;
+	for (USceneComponent* sc : selectedRoots)
+	{
+		if (!sc || IsCoveredBySelectedAncestor(sc)) continue;
+		sessionComponents.Add(sc);
+		if (MovesAttachedChildren(sc)) continue;
+
+		descendants.Reset();
+		sc->GetChildrenComponents(true, descendants);
+		for (USceneComponent* descendant : descendants)
+		{
+			if (SelectedComponents.Contains(descendant) && !SelectedRoots.Contains(descendant)
+				&& !IsCoveredBySelectedAncestor(descendant) && !uncoveredDescendants.Contains(descendant))
+			{
+				uncoveredDescendants.Add(descendant);
+				sessionComponents.Add(descendant);
+			}
+		}
+	}
+
+	for (USceneComponent* sc : sessionComponents)
+	{
+		if (bForceMobility || sc->Mobility == EComponentMobility::Type::Movable)
+		{
+			DragSession.Add(sc, GetSelectedFocusable(sc), sc->GetComponentTransform(), sc->Mobility);
+			//only needs to be set once for the whole drag
+			sc->SetMobility(EComponentMobility::Type::Movable);
+
+			//a Single Delta is a single Teleport, so the Body keeps simulating (and is not woken up again)
+			UPrimitiveComponent* body = Cast<UPrimitiveComponent>(sc);
+			if (bKinematicWhileDragging && !bSingleDelta && body && body->IsSimulatingPhysics())
+			{
+				DragSession.SimulatedBodies.Add(body);
+				DragSession.SimulatedLinearVelocities.Add(body->GetPhysicsLinearVelocity());
+				DragSession.SimulatedAngularVelocities.Add(body->GetPhysicsAngularVelocityInDegrees());
+				body->SetSimulatePhysics(false);
+			}
+		}
+		else
+		{
+			UE_LOG(LogRuntimeTransformer, Warning, TEXT("Transform will not affect Component [%s] as it is NOT Moveable!"), *sc->GetName());
+		}
+	}
+
+	BeginInstanceBatches();
+
+	if (originalStates.Num() > 0)
+	{
+		for (int32 i = 0; i < DragSession.Num(); ++i)
+		{
+			if (const TPair<FTransform, TEnumAsByte<EComponentMobility::Type>>* originalState = originalStates.Find(DragSession.Components[i]))
+			{
+				DragSession.OriginalStartTransforms.Add(DragSession.Components[i], originalState->Key);
+				DragSession.StartMobilities[i] = originalState->Value;
+			}
+		}
+	}
+
+	for (FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
+	{
+		const TMap<int32, FTransform>* originalTransforms = originalInstanceTransforms.Find(batch.InstancedMesh);
+		if (!originalTransforms) continue;
+		for (int32 instanceIndex : batch.InstanceIndices)
+		{
+			if (const FTransform* originalTransform = originalTransforms->Find(instanceIndex))
+				batch.OriginalStartTransforms.Add(instanceIndex, *originalTransform);
+		}
+	}
+
+	//a single Delta dirties the Navigation once anyway
+	if (bDeferNavigationWhileDragging && !bSingleDelta)
+		DeferNavigation();
+
+	if (CommitFrameBudgetMs > 0.f)
+	{
+		DragSession.CommitLapStartTime = FPlatformTime::Seconds();
+		DragSession.PreviousCommitLapStartTime = DragSession.CommitLapStartTime;
+		SortCommitPriority();
+	}
+
+	//Only for actual drags (not for single Deltas, e.g. replicated ones without a Domain)
+	if (ProxyDragThreshold > 0 && DragSession.Num() >= ProxyDragThreshold
+		&& CurrentDomain != ETransformationDomain::TD_None)
+		BuildDragProxy();
+}
+
+void ATransformerPawn::EndDragSession()
+{
+	//The Components have stayed in place while the Proxy was dragged: their final Transforms are committed all at once
+	if (DragSession.bProxyActive && Gizmo.IsValid())
+		EvaluateDragSession();
+
+	//Commits whatever has not reached its final Transform yet (left behind by the Proxy or the Commit Frame Budget)
+	CommitDragSession();
+
+	if (DragSession.bProxyActive)
+		ReleaseDragProxy();
+
+	if (DragSession.bOverlapsDeferred)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ReconcileOverlaps);
+		//overlaps of the whole subtree are updated here, so only once per root
+		for (USceneComponent* component : DragSession.Components)
+		{
+			if (IsValid(component))
+				component->UpdateOverlaps();
+		}
+	}
+
+	//Simulation is restored after the final transform has been set, waking each body only once
+	for (int32 i = 0; i < DragSession.SimulatedBodies.Num(); ++i)
+	{
+		UPrimitiveComponent* body = DragSession.SimulatedBodies[i];
+		if (!IsValid(body)) continue;
+		body->SetSimulatePhysics(true);
+		body->SetPhysicsLinearVelocity(DragSession.SimulatedLinearVelocities[i]);
+		body->SetPhysicsAngularVelocityInDegrees(DragSession.SimulatedAngularVelocities[i]);
+		body->WakeRigidBody();
+	}
+
+	EndInstanceBatches();
+	RestoreNavigation();
+	PendingFocusableTransformations.Reset();
+
+	DragSession.Reset();
+}
+
+void ATransformerPawn::BuildDragProxy()
+{
+	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
+	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+	const bool bSnapPerComponent = snappingEnabled && *snappingEnabled && snappingValue;
+
+	//Translations & Rotations around the Gizmo move every Component the same way
+	DragSession.bProxyRigid = CurrentTransformation != ETransformationType::TT_Scale
+		&& false == bRotateOnLocalAxis && false == bSnapPerComponent;
+
+	//Find the Drag Session Component that moves the Gizmo
+	USceneComponent* anchor = Gizmo.IsValid() && Gizmo->GetRootComponent() 
+		? Gizmo->GetRootComponent()->GetAttachParent() : nullptr;
+	for (int32 i = 0; anchor && i < DragSession.Num(); ++i)
+	{
+		USceneComponent* component = DragSession.Components[i];
+		if (anchor == component || anchor->IsAttachedTo(component))
+		{
+			DragSession.ProxyAnchorIndex = i;
+			break;
+		}
+	}
+
+	if (!DragProxyRoot)
+	{
+		DragProxyRoot = NewObject<USceneComponent>(this, TEXT("DragProxyRoot"));
+		DragProxyRoot->SetMobility(EComponentMobility::Movable);
+		DragProxyRoot->RegisterComponent();
+	}
+
+	const FTransform proxyStartTransform(DragSession.GizmoStartLocation);
+	DragProxyRoot->SetWorldTransform(proxyStartTransform);
+
+	TMap<UStaticMesh*, int32> batchIndices;
+	TArray<USceneComponent*> children;
+	for (int32 i = 0; i < DragSession.Num(); ++i)
+	{
+		if (i == DragSession.ProxyAnchorIndex) continue;
+
+		USceneComponent* component = DragSession.Components[i];
+		children.Reset();
+		component->GetChildrenComponents(true, children);
+		children.Add(component);
+
+		for (USceneComponent* child : children)
+		{
+			UStaticMeshComponent* mesh = Cast<UStaticMeshComponent>(child);
+			//Instanced Meshes are left as they are, rather than previewing each of their instances
+			if (!mesh || !mesh->GetStaticMesh() || !mesh->IsVisible() 
+				|| mesh->IsA<UInstancedStaticMeshComponent>()) continue;
+
+			UStaticMesh* staticMesh = mesh->GetStaticMesh();
+
+			int32* batchIndex = batchIndices.Find(staticMesh);
+			if (!batchIndex)
+			{
+				UInstancedStaticMeshComponent*& instancedMesh = DragProxyMeshes.FindOrAdd(staticMesh);
+				if (!IsValid(instancedMesh))
+				{
+					instancedMesh = NewObject<UInstancedStaticMeshComponent>(this);
+					instancedMesh->SetMobility(EComponentMobility::Movable);
+					instancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+					instancedMesh->SetStaticMesh(staticMesh);
+					instancedMesh->SetupAttachment(DragProxyRoot);
+					instancedMesh->RegisterComponent();
+				}
+
+				//Materials of the first mesh found are used for every instance
+				for (int32 m = 0; m < mesh->GetNumMaterials(); ++m)
+					instancedMesh->SetMaterial(m, mesh->GetMaterial(m));
+				instancedMesh->SetVisibility(true);
+
+				FTransformerDragProxyBatch& batch = DragSession.ProxyBatches.AddDefaulted_GetRef();
+				batch.InstancedMesh = instancedMesh;
+				batchIndex = &batchIndices.Add(staticMesh, DragSession.ProxyBatches.Num() - 1);
+			}
+
+			FTransformerDragProxyBatch& batch = DragSession.ProxyBatches[*batchIndex];
+			const FTransform& meshTransform = mesh->GetComponentTransform();
+			const FTransform relativeTransform = meshTransform.GetRelativeTransform(DragSession.bProxyRigid 
+				? proxyStartTransform : DragSession.StartTransforms.GetTransform(i));
+
+			batch.SessionIndices.Add(i);
+			batch.RelativeTransforms.Add(relativeTransform);
+			//Proxy Root is at the Proxy Start Transform, so for both cases the instance starts where the Mesh is
+			batch.WorldTransforms.Add(meshTransform);
+
+			mesh->SetVisibility(false);
+			DragSession.ProxyHiddenMeshes.Add(mesh);
+		}
+	}
+
+	for (FTransformerDragProxyBatch& batch : DragSession.ProxyBatches)
+	{
+		for (const FTransform& worldTransform : batch.WorldTransforms)
+			batch.InstancedMesh->AddInstanceWorldSpace(worldTransform);
+	}
+
+	DragSession.bProxyActive = true;
+}
+
+void ATransformerPawn::UpdateDragProxy()
+{
+	SCOPE_CYCLE_COUNTER(STAT_UpdateDragProxy);
+
+	const int32 anchorIndex = DragSession.ProxyAnchorIndex;
+
+	if (DragSession.bProxyRigid)
+	{
+		const FTransform& totalDeltaTransform = DragSession.TotalDeltaTransform;
+		DragProxyRoot->SetWorldTransform(FTransform(totalDeltaTransform.GetRotation()
+			, DragSession.GizmoStartLocation + totalDeltaTransform.GetLocation()));
+
+		//Only the Gizmo's Component is calculated
+		if (anchorIndex != INDEX_NONE)
+		{
+			FTransformerMath::ApplyDeltaTransform(DragSession.StartTransforms, DragSession.TargetTransforms
+				, anchorIndex, anchorIndex + 1
+				, totalDeltaTransform, DragSession.GizmoStartLocation, bRotateOnLocalAxis);
+		}
+	}
+	else
+	{
+		EvaluateDragSession();
+
+		for (FTransformerDragProxyBatch& batch : DragSession.ProxyBatches)
+		{
+			for (int32 i = 0; i < batch.SessionIndices.Num(); ++i)
+				batch.WorldTransforms[i] = batch.RelativeTransforms[i] * DragSession.TargetTransforms.GetTransform(batch.SessionIndices[i]);
+
+			//a single render update per Instanced Mesh
+			batch.InstancedMesh->BatchUpdateInstancesTransforms(0, batch.WorldTransforms, true, true, true);
+		}
+	}
+
+	if (anchorIndex != INDEX_NONE)
+	{
+		USceneComponent* anchor = DragSession.Components[anchorIndex];
+		if (IsValid(anchor))
+			SetTransform(anchor, DragSession.Focusables[anchorIndex], DragSession.TargetTransforms.GetTransform(anchorIndex));
+		FlushFocusableTransformations();
+	}
+}
+
+void ATransformerPawn::ReleaseDragProxy()
+{
+	for (FTransformerDragProxyBatch& batch : DragSession.ProxyBatches)
+	{
+		if (!IsValid(batch.InstancedMesh)) continue;
+		batch.InstancedMesh->ClearInstances();
+		batch.InstancedMesh->SetVisibility(false);
+	}
+
+	for (UStaticMeshComponent* mesh : DragSession.ProxyHiddenMeshes)
+	{
+		if (IsValid(mesh))
+			mesh->SetVisibility(true);
+	}
+
+	DragSession.ProxyBatches.Reset();
+	DragSession.ProxyHiddenMeshes.Reset();
+	DragSession.ProxyAnchorIndex = INDEX_NONE;
+	DragSession.bProxyActive = false;
+}
+
+void ATransformerPawn::BeginInstanceBatches()
+{
+	TMap<UInstancedStaticMeshComponent*, int32> batchIndices;
+	//Start Transforms of each batch, in the order they were Selected
+	TArray<TArray<FTransform>> selectedTransforms;
+	USceneComponent* anchor = Gizmo.IsValid() && Gizmo->GetRootComponent()
+		? Gizmo->GetRootComponent()->GetAttachParent() : nullptr;
+	const bool bAnchoredToInstance = anchor && anchor == InstanceGizmoAnchor;
+
+	for (const FSelectedInstance& selectedInstance : SelectedInstances.GetArray())
+	{
+		UInstancedStaticMeshComponent* instancedMesh = selectedInstance.Component;
+		if (!IsValid(instancedMesh) || !instancedMesh->IsValidInstance(selectedInstance.InstanceIndex)) continue;
+
+		int32 batchIndex;
+		if (int32* foundIndex = batchIndices.Find(instancedMesh))
+			batchIndex = *foundIndex;
+		else
+		{
+			batchIndex = DragSession.InstanceBatches.AddDefaulted();
+			selectedTransforms.AddDefaulted();
+			batchIndices.Add(instancedMesh, batchIndex);
+			DragSession.InstanceBatches[batchIndex].InstancedMesh = instancedMesh;
+		}
+
+		FTransformerInstanceBatch& batch = DragSession.InstanceBatches[batchIndex];
+		FTransform instanceTransform;
+		instancedMesh->GetInstanceTransform(selectedInstance.InstanceIndex, instanceTransform, true);
+
+		if (bAnchoredToInstance && selectedInstance == AnchoredInstance)
+		{
+			DragSession.AnchorInstanceBatch = batchIndex;
+			DragSession.AnchorInstanceSlot = batch.InstanceIndices.Num();
+		}
+
+		batch.InstanceIndices.Add(selectedInstance.InstanceIndex);
+		selectedTransforms[batchIndex].Add(instanceTransform);
+	}
+
+	for (int32 batchIndex = 0; batchIndex < DragSession.InstanceBatches.Num(); ++batchIndex)
+	{
+		FTransformerInstanceBatch& batch = DragSession.InstanceBatches[batchIndex];
+		const int32 count = batch.InstanceIndices.Num();
+
+		//Sorted so that consecutive Instance Indices end up next to each other
+		TArray<int32> order;
+		order.SetNum(count);
+		for (int32 i = 0; i < count; ++i)
+			order[i] = i;
+		order.Sort([&batch](int32 a, int32 b) { return batch.InstanceIndices[a] < batch.InstanceIndices[b]; });
+
+		TArray<int32> instanceIndices;
+		instanceIndices.SetNum(count);
+		batch.StartTransforms.SetNum(count);
+		for (int32 i = 0; i < count; ++i)
+		{
+			instanceIndices[i] = batch.InstanceIndices[order[i]];
+			batch.StartTransforms.SetTransform(i, selectedTransforms[batchIndex][order[i]]);
+			if (batchIndex == DragSession.AnchorInstanceBatch && order[i] == DragSession.AnchorInstanceSlot)
+				DragSession.AnchorInstanceSlot = i;
+		}
+		batch.InstanceIndices = MoveTemp(instanceIndices);
+		batch.TargetTransforms = batch.StartTransforms;
+
+		for (int32 i = 1; i < count; ++i)
+		{
+			if (batch.InstanceIndices[i] != batch.InstanceIndices[i - 1] + 1)
+				batch.RunEnds.Add(i);
+		}
+		batch.RunEnds.Add(count);
+
+		//The Tree is rebuilt once when the drag finishes, rather than on every update
+		if (UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh = Cast<UHierarchicalInstancedStaticMeshComponent>(batch.InstancedMesh))
+		{
+			batch.bRestoreAutoRebuildTree = hierarchicalMesh->bAutoRebuildTreeOnInstanceChanges;
+			hierarchicalMesh->bAutoRebuildTreeOnInstanceChanges = false;
+		}
+	}
+}
+
+void ATransformerPawn::EndInstanceBatches()
+{
+	for (FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
+	{
+		UHierarchicalInstancedStaticMeshComponent* hierarchicalMesh = Cast<UHierarchicalInstancedStaticMeshComponent>(batch.InstancedMesh);
+		if (!IsValid(hierarchicalMesh) || !batch.bRestoreAutoRebuildTree) continue;
+
+		hierarchicalMesh->bAutoRebuildTreeOnInstanceChanges = true;
+		hierarchicalMesh->BuildTreeIfOutdated(true, false);
+	}
 }
 
-bool ATransformerPawn::TraceByProfile(const FVector& StartLocation
-	, const FVector& EndLocation
-	, const FName& ProfileName, TArray<AActor*> IgnoredActors
-	, bool bAppendToList)
+void ATransformerPawn::EvaluateInstanceBatches()
 {
-	if (UWorld* world = GetWorld())
+	if (DragSession.InstanceBatches.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_EvaluateTransforms);
+
+	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
+	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+	const bool bSnapPerComponent = snappingEnabled && *snappingEnabled && snappingValue;
+
+	for (FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
 	{
-		FCollisionQueryParams CollisionQueryParams;
-		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+		const int32 count = batch.InstanceIndices.Num();
+		FTransformerMath::ApplyDeltaTransform(batch.StartTransforms, batch.TargetTransforms, 0, count
+			, DragSession.TotalDeltaTransform, DragSession.GizmoStartLocation, bRotateOnLocalAxis);
 
-		TArray<FHitResult> OutHits;
-		if (world->LineTraceMultiByProfile(OutHits, StartLocation, EndLocation
-			, ProfileName, CollisionQueryParams))
+		/* SNAPPING LOGIC PER INSTANCE */
+		if (!bSnapPerComponent) continue;
+		for (int32 i = 0; i < count; ++i)
 		{
-			FilterHits(OutHits);
-			return HandleTracedObjects(OutHits, bAppendToList);
+			batch.TargetTransforms.SetTransform(i, Gizmo->GetSnappedTransformPerComponent(batch.StartTransforms.GetTransform(i)
+				, batch.TargetTransforms.GetTransform(i), CurrentDomain, *snappingValue));
 		}
 	}
-	return false;
 }
 
-#include "Kismet/GameplayStatics.h"
-void ATransformerPawn::Tick(float DeltaSeconds)
+void ATransformerPawn::CommitInstanceBatches()
 {
-	Super::Tick(DeltaSeconds);
-	if (!Gizmo.IsValid()) return;
+	if (DragSession.InstanceBatches.Num() == 0) return;
 
-	if (APlayerController* PlayerController = Cast< APlayerController>(Controller))
+	SCOPE_CYCLE_COUNTER(STAT_CommitTransforms);
+
+	for (FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
 	{
-		FVector worldLocation, worldDirection;
-		if (PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
+		if (!IsValid(batch.InstancedMesh)) continue;
+
+		//one update per run of consecutive Instances, but a single render state update per Instanced Mesh
+		int32 runStart = 0;
+		for (int32 run = 0; run < batch.RunEnds.Num(); ++run)
 		{
-			if (PlayerController->DeprojectMousePositionToWorld(worldLocation, worldDirection))
-			{
-				FTransform deltaTransform = UpdateTransform(PlayerController->PlayerCameraManager->GetActorForwardVector()
-					, worldLocation, worldDirection);
+			const int32 runEnd = batch.RunEnds[run];
+			const bool bLastRun = run == batch.RunEnds.Num() - 1;
 
-				NetworkDeltaTransform = FTransform(
-					deltaTransform.GetRotation() * NetworkDeltaTransform.GetRotation(),
-					deltaTransform.GetLocation() + NetworkDeltaTransform.GetLocation(),
-					deltaTransform.GetScale3D() + NetworkDeltaTransform.GetScale3D());
+			//lone Instances don't need the copy into RunTransforms
+			if (runEnd - runStart == 1)
+				batch.InstancedMesh->UpdateInstanceTransform(batch.InstanceIndices[runStart]
+					, batch.TargetTransforms.GetTransform(runStart), true, bLastRun, true);
+			else
+			{
+				batch.RunTransforms.Reset();
+				for (int32 i = runStart; i < runEnd; ++i)
+					batch.RunTransforms.Add(batch.TargetTransforms.GetTransform(i));
+				batch.InstancedMesh->BatchUpdateInstancesTransforms(batch.InstanceIndices[runStart]
+					, batch.RunTransforms, true, bLastRun, true);
 			}
-				
-		}			
+			runStart = runEnd;
+		}
+		INC_DWORD_STAT_BY(STAT_TransformedInstances, batch.InstanceIndices.Num());
 	}
-	
-	//Only consider Local View
-	if (APlayerController* LocalPlayerController = UGameplayStatics::GetPlayerController(this, 0))
+
+	//the Gizmo follows the Instance it was placed on
+	if (DragSession.AnchorInstanceBatch != INDEX_NONE && IsValid(InstanceGizmoAnchor))
 	{
-		if (LocalPlayerController->PlayerCameraManager)
+		const FTransformerInstanceBatch& anchorBatch = DragSession.InstanceBatches[DragSession.AnchorInstanceBatch];
+		InstanceGizmoAnchor->SetWorldTransform(anchorBatch.TargetTransforms.GetTransform(DragSession.AnchorInstanceSlot));
+	}
+}
+
+void ATransformerPawn::DeferNavigation()
+{
+	if (!FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld())) return;
+
+	DragSession.NavigationCounts.SetNumZeroed(DragSession.Num());
+	TArray<USceneComponent*> children;
+	for (int32 i = 0; i < DragSession.Num(); ++i)
+	{
+		USceneComponent* component = DragSession.Components[i];
+		children.Reset();
+		component->GetChildrenComponents(true, children);
+		children.Add(component);
+		for (USceneComponent* child : children)
 		{
-			Gizmo->ScaleGizmoScene(LocalPlayerController->PlayerCameraManager->GetCameraLocation()
-				, LocalPlayerController->PlayerCameraManager->GetActorForwardVector()
-				, LocalPlayerController->PlayerCameraManager->GetFOVAngle());
+			if (!child->CanEverAffectNavigation()) continue;
+			DragSession.NavigationComponents.Add(child);
+			++DragSession.NavigationCounts[i];
 		}
 	}
 
+	if (DragSession.NavigationComponents.Num() == 0)
+	{
+		DragSession.NavigationCounts.Reset();
+		return;
+	}
+	DragSession.bNavigationDeferred = true;
+
+	//Dirties the Start area once, and prevents every move from dirtying the area it moves through
+	for (USceneComponent* component : DragSession.NavigationComponents)
+		component->SetCanEverAffectNavigation(false);
+}
 
+void ATransformerPawn::RestoreNavigation()
+{
+	if (false == DragSession.bNavigationDeferred) return;
 
-	Gizmo->UpdateGizmoSpace(CurrentSpaceType); //ToDo: change when this is called to improve performance when a gizmo is there without doing anything
+	//Dirties the End area once. Only the dirty areas get rebuilt, never the whole Navigation
+	for (USceneComponent* component : DragSession.NavigationComponents)
+	{
+		if (IsValid(component))
+			component->SetCanEverAffectNavigation(true);
+	}
+	DragSession.bNavigationDeferred = false;
 }
 
-FTransform ATransformerPawn::UpdateTransform(const FVector& LookingVector
-	, const FVector& RayOrigin
-	, const FVector& RayDirection)
+void ATransformerPawn::ApplyDragSession()
 {
-	FTransform deltaTransform;
-	deltaTransform.SetScale3D(FVector::ZeroVector);
+	if (!Gizmo.IsValid()) return;
 
-	if (!Gizmo.IsValid() || CurrentDomain == ETransformationDomain::TD_None) 
-		return deltaTransform;
+	//Instances are already updated in batches, so they go through neither the Proxy nor the Commit Frame Budget
+	EvaluateInstanceBatches();
+	CommitInstanceBatches();
 
-	FVector rayEnd = RayOrigin + 1'000'000'00 * RayDirection;
+	if (DragSession.bProxyActive)
+	{
+		UpdateDragProxy();
+		return;
+	}
 
-	FTransform calcDeltaTransform = Gizmo->GetDeltaTransform(LookingVector, RayOrigin, rayEnd, CurrentDomain);
+	EvaluateDragSession();
+	CommitDragSession(true);
+}
 
-	//The delta transform we are actually going to apply (same if there is no Snapping taking place)
-	deltaTransform = calcDeltaTransform;
+void ATransformerPawn::EvaluateDragSession()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EvaluateTransforms);
+	++DragSession.TargetVersion;
+	//none is up to date with the new Version
+	DragSession.CommitBacklog = DragSession.Num();
 
-	/* SNAPPING LOGIC */
 	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
 	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+	const bool bSnapPerComponent = snappingEnabled && *snappingEnabled && snappingValue;
+	const float snapValue = bSnapPerComponent ? *snappingValue : 0.f;
 
-	if (snappingEnabled && *snappingEnabled && snappingValue)
-			deltaTransform = Gizmo->GetSnappedTransform(AccumulatedDeltaTransform
-				, calcDeltaTransform, CurrentDomain, *snappingValue);
-				//GetSnapped Transform Modifies Accumulated Delta Transform by how much Snapping Occurred
-	
-	ApplyDeltaTransform(deltaTransform);
-	return deltaTransform;
+	const ABaseGizmo* gizmo = Gizmo.Get();
+	const ETransformationDomain domain = CurrentDomain;
+	const bool bRotateLocal = bRotateOnLocalAxis;
+
+	const FTransform& totalDeltaTransform = DragSession.TotalDeltaTransform;
+	const FVector& pivot = DragSession.GizmoStartLocation;
+
+	const FTransformSoA& startTransforms = DragSession.StartTransforms;
+	FTransformSoA& targetTransforms = DragSession.TargetTransforms;
+
+	//Blocks are a multiple of 4 so that only the last block has a scalar remainder
+	const int32 blockSize = 64;
+	const int32 blockCount = FMath::DivideAndRoundUp(DragSession.Num(), blockSize);
+
+	//Every Component's Transform is independent of the rest, so this can safely go wide
+	auto EvaluateBlock = [&](int32 block)
+	{
+		const int32 beginIndex = block * blockSize;
+		const int32 endIndex = FMath::Min(beginIndex + blockSize, DragSession.Num());
+
+		FTransformerMath::ApplyDeltaTransform(startTransforms, targetTransforms, beginIndex, endIndex
+			, totalDeltaTransform, pivot, bRotateLocal);
+
+		/* SNAPPING LOGIC PER COMPONENT */
+		if (!bSnapPerComponent) return;
+		for (int32 i = beginIndex; i < endIndex; ++i)
+		{
+			targetTransforms.SetTransform(i, gizmo->GetSnappedTransformPerComponent(startTransforms.GetTransform(i)
+				, targetTransforms.GetTransform(i), domain, snapValue));
+		}
+	};
+
+	const bool bSingleThreaded = ParallelTransformThreshold <= 0 
+		|| DragSession.Num() < ParallelTransformThreshold;
+	ParallelFor(blockCount, EvaluateBlock, bSingleThreaded);
 }
 
-void ATransformerPawn::ApplyDeltaTransform(const FTransform& DeltaTransform)
+void ATransformerPawn::CommitDragSession(bool bWithinBudget)
 {
-	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
-	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+	SCOPE_CYCLE_COUNTER(STAT_CommitTransforms);
 
-	for (auto& sc : SelectedComponents)
+	const double now = FPlatformTime::Seconds();
+	int32 committedCount = 0;
+	//every Navigation Component moved would have dirtied the Navigation Area it moved through, had it not been deferred
+	int32 deferredDirtyAreas = 0;
+
+	auto IsUpToDate = [this](int32 i) { return DragSession.CommittedVersions[i] == DragSession.TargetVersion; };
+	auto Commit = [&](int32 i)
 	{
-		if (!sc) continue;
-		if (bForceMobility || sc->Mobility == EComponentMobility::Type::Movable)
+		USceneComponent* sc = DragSession.Components[i];
+		if (IsValid(sc))
+			SetTransform(sc, DragSession.Focusables[i], DragSession.TargetTransforms.GetTransform(i));
+		if (DragSession.bNavigationDeferred)
+			deferredDirtyAreas += DragSession.NavigationCounts[i];
+		DragSession.CommittedVersions[i] = DragSession.TargetVersion;
+		--DragSession.CommitBacklog;
+		++committedCount;
+	};
+
+	if (false == bWithinBudget || CommitFrameBudgetMs <= 0.f)
+	{
+		for (int32 i = 0; i < DragSession.Num(); ++i)
 		{
-			const FTransform& componentTransform = sc->GetComponentTransform();
-
-			FQuat deltaRotation = DeltaTransform.GetRotation();
+			if (!IsUpToDate(i))
+				Commit(i);
+		}
+		DragSession.CommitBacklog = 0;
+		INC_DWORD_STAT_BY(STAT_TransformedComponents, committedCount);
+		INC_DWORD_STAT_BY(STAT_DeferredNavigationDirtyAreas, deferredDirtyAreas);
+		FlushFocusableTransformations();
+		return;
+	}
 
-			FVector deltaLocation = componentTransform.GetLocation()
-				- Gizmo->GetActorLocation();
+	//e.g. the Budget was only set mid-drag
+	if (DragSession.CommitPriority.Num() != DragSession.Num())
+		SortCommitPriority();
 
-			//DeltaScale is Unrotated Scale to Get Local Scale since World Scale is not supported
-			FVector deltaScale = componentTransform.GetRotation()
-				.UnrotateVector(DeltaTransform.GetScale3D());
+	DragSession.LastBudgetedCommitFrame = GFrameCounter;
+	const double endTime = now + CommitFrameBudgetMs / 1000.0;
+	//part of the Budget is kept for the round robin, so that the Components out of view always make progress
+	const double visibleEndTime = now + CommitFrameBudgetMs * (1.f - CommitRoundRobinShare) / 1000.0;
 
+	//Reading the time is not free, so it's only checked every few Components
+	int32 checkedCount = 0;
+	auto IsOverBudget = [&checkedCount](double budgetEndTime) { return (checkedCount++ & 15) == 0 && FPlatformTime::Seconds() > budgetEndTime; };
 
-			if (false == bRotateOnLocalAxis)
-				deltaLocation = deltaRotation.RotateVector(deltaLocation);
+	const TArray<int32>& commitPriority = DragSession.CommitPriority;
+	const int32 priorityCount = commitPriority.Num();
 
-			FTransform newTransform(
-				deltaRotation * componentTransform.GetRotation(),
-				//adding Gizmo Location + prevDeltaLocation 
-				// (i.e. location from Gizmo to Object after optional Rotating)
-				// + deltaTransform Location Offset
-				deltaLocation + Gizmo->GetActorLocation() + DeltaTransform.GetLocation(),
-				deltaScale + componentTransform.GetScale3D());
+	//What is being looked at goes first (closest to the camera first), resuming where the last frame stopped
+	for (int32 n = 0; n < priorityCount && DragSession.CommitBacklog > 0; ++n)
+	{
+		if (IsOverBudget(visibleEndTime)) break;
+
+		const int32 i = commitPriority[DragSession.VisibleCommitCursor];
+		DragSession.VisibleCommitCursor = (DragSession.VisibleCommitCursor + 1) % priorityCount;
+		if (IsUpToDate(i)) continue;
+
+		USceneComponent* sc = DragSession.Components[i];
+		UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(sc);
+		AActor* owner = IsValid(sc) ? sc->GetOwner() : nullptr;
+		const bool bRecentlyRendered = primitive ? primitive->WasRecentlyRendered() : (owner && owner->WasRecentlyRendered());
+		if (bRecentlyRendered)
+			Commit(i);
+	}
 
+	//The rest catch up round robin
+	checkedCount = 0;
+	for (int32 n = 0; n < priorityCount && DragSession.CommitBacklog > 0; ++n)
+	{
+		if (IsOverBudget(endTime)) break;
 
-			/* SNAPPING LOGIC PER COMPONENT */
-			if (snappingEnabled && *snappingEnabled && snappingValue)
-				newTransform = Gizmo->GetSnappedTransformPerComponent(componentTransform
-					, newTransform, CurrentDomain, *snappingValue);
+		const int32 i = commitPriority[DragSession.CommitCursor];
+		if (!IsUpToDate(i))
+			Commit(i);
 
-			sc->SetMobility(EComponentMobility::Type::Movable);
-			SetTransform(sc, newTransform);
-		}
-		else
+		if (++DragSession.CommitCursor == priorityCount)
 		{
-			UE_LOG(LogRuntimeTransformer, Warning, TEXT("Transform will not affect Component [%s] as it is NOT Moveable!"), *sc->GetName());
+			DragSession.CommitCursor = 0;
+			DragSession.PreviousCommitLapStartTime = DragSession.CommitLapStartTime;
+			DragSession.CommitLapStartTime = now;
 		}
-			
 	}
+
+	INC_DWORD_STAT_BY(STAT_TransformedComponents, committedCount);
+	INC_DWORD_STAT_BY(STAT_DeferredNavigationDirtyAreas, deferredDirtyAreas);
+	FlushFocusableTransformations();
+	SET_DWORD_STAT(STAT_CommitBacklog, DragSession.CommitBacklog);
+	//every Component ahead of the round robin was last committed after the previous lap started
+	SET_FLOAT_STAT(STAT_CommitCatchUpLatency, DragSession.CommitBacklog > 0 ? (now - DragSession.PreviousCommitLapStartTime) * 1000.0 : 0.0);
+}
+
+void ATransformerPawn::SortCommitPriority()
+{
+	TArray<int32>& commitPriority = DragSession.CommitPriority;
+	commitPriority.SetNumUninitialized(DragSession.Num());
+	for (int32 i = 0; i < commitPriority.Num(); ++i)
+		commitPriority[i] = i;
+	DragSession.CommitCursor = 0;
+	DragSession.VisibleCommitCursor = 0;
+
+	//Only consider Local View
+	APlayerController* localPlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	if (!localPlayerController || !localPlayerController->PlayerCameraManager) return;
+
+	const FVector cameraLocation = localPlayerController->PlayerCameraManager->GetCameraLocation();
+	const FTransformSoA& startTransforms = DragSession.StartTransforms;
+	commitPriority.Sort([&](int32 a, int32 b)
+	{
+		return FVector::DistSquared(startTransforms.GetLocation(a), cameraLocation)
+			< FVector::DistSquared(startTransforms.GetLocation(b), cameraLocation);
+	});
 }
 
 bool ATransformerPawn::HandleTracedObjects(const TArray<FHitResult>& HitResults
@@ -473,7 +2048,11 @@ bool ATransformerPawn::HandleTracedObjects(const TArray<FHitResult>& HitResults
 		if (Cast<ABaseGizmo>(hits.Actor))
 			continue; //ignore other Gizmos.
 
-		if (bComponentBased)
+		//For Instanced Static Meshes, the Item hit is the Instance Index
+		UInstancedStaticMeshComponent* instancedMesh = Cast<UInstancedStaticMeshComponent>(hits.GetComponent());
+		if (bSelectInstances && instancedMesh && hits.Item != INDEX_NONE)
+			SelectInstance(instancedMesh, hits.Item, bAppendToList);
+		else if (bComponentBased)
 			SelectComponent(Cast<USceneComponent>(hits.GetComponent()), bAppendToList);
 		else
 			SelectActor(hits.GetActor(), bAppendToList);
@@ -484,8 +2063,38 @@ bool ATransformerPawn::HandleTracedObjects(const TArray<FHitResult>& HitResults
 	return false;
 }
 
+void ATransformerPawn::RegisterSelectable(UPrimitiveComponent* Component)
+{
+	SelectionIndex.Add(Component);
+}
+
+void ATransformerPawn::UnregisterSelectable(UPrimitiveComponent* Component)
+{
+	SelectionIndex.Remove(Component);
+}
+
+void ATransformerPawn::RegisterSelectableActor(AActor* Actor)
+{
+	if (!Actor) return;
+
+	TInlineComponentArray<UPrimitiveComponent*> primitiveComponents(Actor);
+	for (UPrimitiveComponent* primitiveComponent : primitiveComponents)
+		SelectionIndex.Add(primitiveComponent);
+}
+
+void ATransformerPawn::UnregisterSelectableActor(AActor* Actor)
+{
+	if (!Actor) return;
+
+	TInlineComponentArray<UPrimitiveComponent*> primitiveComponents(Actor);
+	for (UPrimitiveComponent* primitiveComponent : primitiveComponents)
+		SelectionIndex.Remove(primitiveComponent);
+}
+
 void ATransformerPawn::SetComponentBased(bool bIsComponentBased)
 {
+	FScopedSelectionBatch selectionBatch(this);
+
 	auto selectedComponents = DeselectAll();
 	bComponentBased = bIsComponentBased;
 	if(bComponentBased)
@@ -537,14 +2146,19 @@ void ATransformerPawn::SetSnappingValue(ETransformationType TransformationType,
 void ATransformerPawn::GetSelectedComponents(TArray<class USceneComponent*>& outComponentList
 	, USceneComponent*& outGizmoPlacedComponent) const
 {
-	outComponentList = SelectedComponents;
+	outComponentList = SelectedComponents.GetArray();
 	if (Gizmo.IsValid())
 		outGizmoPlacedComponent = Gizmo->GetParentComponent();
 }
 
-TArray<USceneComponent*> ATransformerPawn::GetSelectedComponents() const
+const TArray<USceneComponent*>& ATransformerPawn::GetSelectedComponents() const
 {
-	return SelectedComponents;
+	return SelectedComponents.GetArray();
+}
+
+const TArray<USceneComponent*>& ATransformerPawn::GetSelectedRoots() const
+{
+	return SelectedRoots.GetArray();
 }
 
 void ATransformerPawn::CloneSelected(bool bSelectNewClones
@@ -556,7 +2170,7 @@ void ATransformerPawn::CloneSelected(bool bSelectNewClones
     }
 		
 
-	auto CloneComponents = CloneFromList(SelectedComponents);
+	auto CloneComponents = CloneFromList(SelectedComponents.GetArray());
 
 	if (bSelectNewClones)
 		SelectMultipleComponents(CloneComponents, bAppendToList);
@@ -727,9 +2341,10 @@ void ATransformerPawn::SelectComponent(class USceneComponent* Component
 
 	if (ShouldSelect(Component->GetOwner(), Component))
 	{
+		FScopedSelectionBatch selectionBatch(this);
 		if (false == bAppendToList)
 			DeselectAll();
-		AddComponent_Internal(SelectedComponents, Component);
+		AddComponent_Internal(Component);
 		UpdateGizmoPlacement();
 	}
 }
@@ -741,9 +2356,10 @@ void ATransformerPawn::SelectActor(AActor* Actor
 
 	if (ShouldSelect(Actor, Actor->GetRootComponent()))
 	{
+		FScopedSelectionBatch selectionBatch(this);
 		if (false == bAppendToList)
 			DeselectAll();
-		AddComponent_Internal(SelectedComponents, Actor->GetRootComponent());
+		AddComponent_Internal(Actor->GetRootComponent());
 		UpdateGizmoPlacement();
 	}
 }
@@ -751,6 +2367,7 @@ void ATransformerPawn::SelectActor(AActor* Actor
 void ATransformerPawn::SelectMultipleComponents(const TArray<USceneComponent*>& Components
 	, bool bAppendToList)
 {
+	FScopedSelectionBatch selectionBatch(this);
 	bool bValidList = false;
 
 	for (auto& c : Components)
@@ -765,193 +2382,430 @@ void ATransformerPawn::SelectMultipleComponents(const TArray<USceneComponent*>&
 			//only run once. This is not place outside in case a list is empty or contains only invalid components
 		}
 		bValidList = true;
-		AddComponent_Internal(SelectedComponents, c);
+		AddComponent_Internal(c);
+	}
+
+	if(bValidList) UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::SelectMultipleActors(const TArray<AActor*>& Actors
+	, bool bAppendToList)
+{
+	FScopedSelectionBatch selectionBatch(this);
+	bool bValidList = false;
+	for (auto& a : Actors)
+	{
+		if (!a) continue;
+		if (!ShouldSelect(a, a->GetRootComponent())) continue;
+
+		if (false == bAppendToList)
+		{
+			DeselectAll();
+			bAppendToList = true;
+			//only run once. This is not place outside in case a list is empty or contains only invalid components
+		}
+
+		bValidList = true;
+		AddComponent_Internal(a->GetRootComponent());
+	}
+	if(bValidList) UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::DeselectComponent(USceneComponent* Component)
+{
+	if (!Component) return;
+	FScopedSelectionBatch selectionBatch(this);
+	DeselectComponent_Internal(Component);
+	UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::DeselectActor(AActor* Actor)
+{
+	if (Actor)
+		DeselectComponent(Actor->GetRootComponent());
+}
+
+TArray<USceneComponent*> ATransformerPawn::DeselectAll(bool bDestroyDeselected)
+{
+	TArray<USceneComponent*> componentsToDeselect = SelectedComponents.GetArray();
+	{
+		//Batch so that the Gizmo is only updated once for all the deselections
+		FScopedSelectionBatch selectionBatch(this);
+		//everything is going away, so there's no need to promote any Selected Descendants to Roots
+		SelectedRoots.Empty();
+		for (auto& i : componentsToDeselect)
+			DeselectComponent_Internal(i);
+		SelectedComponents.Empty();
+		SelectedFocusables.Reset();
+		BatchedFocusables.Reset();
+
+		TArray<FSelectedInstance> instancesToDeselect = SelectedInstances.GetArray();
+		for (const FSelectedInstance& instance : instancesToDeselect)
+			DeselectInstance_Internal(instance);
+
+		UpdateGizmoPlacement();
+
+		if (bDestroyDeselected && instancesToDeselect.Num() > 0)
+		{
+			//Removing an Instance shifts the indices of the ones after it, so remove from the highest index down
+			instancesToDeselect.Sort([](const FSelectedInstance& a, const FSelectedInstance& b)
+			{
+				return a.InstanceIndex > b.InstanceIndex;
+			});
+			for (const FSelectedInstance& instance : instancesToDeselect)
+			{
+				if (IsValid(instance.Component))
+					instance.Component->RemoveInstance(instance.InstanceIndex);
+			}
+		}
 	}
 
-	if(bValidList) UpdateGizmoPlacement();
+	if (bDestroyDeselected)
+	{
+		for (auto& c : componentsToDeselect)
+		{
+			if (!IsValid(c)) continue; //a component that was in the same actor destroyed will be pending kill
+			if (AActor* actor = c->GetOwner())
+			{
+				//We destroy the actor if no components are left to destroy, or the system is currently ActorBased
+				if (bComponentBased && actor->GetComponents().Num() > 1)
+					c->DestroyComponent(true);
+				else
+					actor->Destroy();
+			}
+		}
+	}
+
+	return componentsToDeselect;
+}
+
+void ATransformerPawn::SelectInstance(UInstancedStaticMeshComponent* Component, int32 InstanceIndex
+	, bool bAppendToList)
+{
+	if (!Component || !Component->IsValidInstance(InstanceIndex)) return;
+
+	if (ShouldSelect(Component->GetOwner(), Component))
+	{
+		FScopedSelectionBatch selectionBatch(this);
+		if (false == bAppendToList)
+			DeselectAll();
+		AddInstance_Internal(FSelectedInstance(Component, InstanceIndex));
+		UpdateGizmoPlacement();
+	}
+}
+
+void ATransformerPawn::DeselectInstance(UInstancedStaticMeshComponent* Component, int32 InstanceIndex)
+{
+	if (!Component) return;
+	FScopedSelectionBatch selectionBatch(this);
+	DeselectInstance_Internal(FSelectedInstance(Component, InstanceIndex));
+	UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::GetSelectedInstances(TArray<FSelectedInstance>& outInstances) const
+{
+	outInstances = SelectedInstances.GetArray();
+}
+
+const TArray<FSelectedInstance>& ATransformerPawn::GetSelectedInstances() const
+{
+	return SelectedInstances.GetArray();
+}
+
+void ATransformerPawn::AddInstance_Internal(const FSelectedInstance& Instance)
+{
+	if (SelectedInstances.Add(Instance))
+	{
+		//if it was removed in this batch, then it's not a change at all
+		if (!PendingRemovedInstances.Remove(Instance))
+			PendingAddedInstances.Add(Instance);
+	}
+	else if (bToggleSelectedInMultiSelection)
+		DeselectInstance_Internal(Instance);
+}
+
+void ATransformerPawn::DeselectInstance_Internal(const FSelectedInstance& Instance)
+{
+	if (SelectedInstances.Remove(Instance))
+	{
+		//if it was added in this batch, then it's not a change at all
+		if (!PendingAddedInstances.Remove(Instance))
+			PendingRemovedInstances.Add(Instance);
+	}
+}
+
+USceneComponent* ATransformerPawn::PlaceInstanceGizmoAnchor(const FSelectedInstance& Instance)
+{
+	if (!IsValid(Instance.Component) || !Instance.Component->IsValidInstance(Instance.InstanceIndex))
+		return nullptr;
+
+	if (!InstanceGizmoAnchor)
+	{
+		InstanceGizmoAnchor = NewObject<USceneComponent>(this, TEXT("InstanceGizmoAnchor"));
+		InstanceGizmoAnchor->SetMobility(EComponentMobility::Movable);
+		InstanceGizmoAnchor->RegisterComponent();
+	}
+
+	FTransform instanceTransform;
+	Instance.Component->GetInstanceTransform(Instance.InstanceIndex, instanceTransform, true);
+	InstanceGizmoAnchor->SetWorldTransform(instanceTransform);
+	AnchoredInstance = Instance;
+	return InstanceGizmoAnchor;
+}
+
+void ATransformerPawn::AddComponent_Internal(USceneComponent* Component)
+{
+	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+
+	if (SelectedComponents.Add(Component)) //Component was not in list
+	{
+		AddSelectedRoot_Internal(Component);
+
+		bool bImplementsInterface;
+		Select(Component, &bImplementsInterface);
+
+		//if it was removed in this batch, then it's not a change at all
+		if (!PendingRemovedComponents.Remove(Component))
+			PendingAddedComponents.Add(Component);
+
+		if (!bCoalesceSelectionEvents || !IsInSelectionBatch())
+			OnComponentSelectionChange(Component, true, bImplementsInterface);
+	}
+	else if (bToggleSelectedInMultiSelection)
+		DeselectComponent_Internal(Component);
 }
 
-void ATransformerPawn::SelectMultipleActors(const TArray<AActor*>& Actors
-	, bool bAppendToList)
+void ATransformerPawn::DeselectComponent_Internal(USceneComponent* Component)
 {
-	bool bValidList = false;
-	for (auto& a : Actors)
+	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+
+	if (SelectedComponents.Contains(Component))
 	{
-		if (!a) continue;
-		if (!ShouldSelect(a, a->GetRootComponent())) continue;
+		bool bImplementsInterface;
+		Deselect(Component, &bImplementsInterface);
+		SelectedComponents.Remove(Component);
+		RemoveSelectedRoot_Internal(Component);
 
-		if (false == bAppendToList)
-		{
-			DeselectAll();
-			bAppendToList = true;
-			//only run once. This is not place outside in case a list is empty or contains only invalid components
-		}
+		//if it was added in this batch, then it's not a change at all
+		if (!PendingAddedComponents.Remove(Component))
+			PendingRemovedComponents.Add(Component);
 
-		bValidList = true;
-		AddComponent_Internal(SelectedComponents, a->GetRootComponent());
+		if (!bCoalesceSelectionEvents || !IsInSelectionBatch())
+			OnComponentSelectionChange(Component, false, bImplementsInterface);
 	}
-	if(bValidList) UpdateGizmoPlacement();
 }
 
-void ATransformerPawn::DeselectComponent(USceneComponent* Component)
+bool ATransformerPawn::MovesAttachedChildren(USceneComponent* Component) const
 {
-	if (!Component) return;
-	DeselectComponent_Internal(SelectedComponents, Component);
-	UpdateGizmoPlacement();
-}
+	//BeginDragSession skips it altogether
+	if (!bForceMobility && Component->Mobility != EComponentMobility::Type::Movable)
+		return false;
 
-void ATransformerPawn::DeselectActor(AActor* Actor)
-{
-	if (Actor)
-		DeselectComponent(Actor->GetRootComponent());
+	//only gets OnNewTransformation, its Transform is left as it is
+	return bTransformUFocusableObjects || !GetSelectedFocusable(Component);
 }
 
-TArray<USceneComponent*> ATransformerPawn::DeselectAll(bool bDestroyDeselected)
+bool ATransformerPawn::IsCoveredBySelectedAncestor(USceneComponent* Component) const
 {
-	TArray<USceneComponent*> componentsToDeselect = SelectedComponents;
-	for (auto& i : componentsToDeselect)
-		DeselectComponent(i);
-		//calling internal so as not to modify SelectedComponents until the last bit!
-	SelectedComponents.Empty();
-	UpdateGizmoPlacement();
+	//a Focusable gets OnNewTransformation only if it is transformed itself
+	if (GetSelectedFocusable(Component))
+		return false;
 
-	if (bDestroyDeselected)
+	USceneComponent* child = Component;
+	while (USceneComponent* parent = child->GetAttachParent())
 	{
-		for (auto& c : componentsToDeselect)
-		{
-			if (!IsValid(c)) continue; //a component that was in the same actor destroyed will be pending kill
-			if (AActor* actor = c->GetOwner())
-			{
-				//We destroy the actor if no components are left to destroy, or the system is currently ActorBased
-				if (bComponentBased && actor->GetComponents().Num() > 1)
-					c->DestroyComponent(true);
-				else
-					actor->Destroy();
-			}
-		}
-	}
+		//an Absolute Component does not (fully) follow its parent, so the chain is broken here
+		if (child->IsUsingAbsoluteLocation() || child->IsUsingAbsoluteRotation() || child->IsUsingAbsoluteScale())
+			return false;
 
-	return componentsToDeselect;
+		if (SelectedComponents.Contains(parent) && MovesAttachedChildren(parent))
+			return true;
+
+		child = parent;
+	}
+	return false;
 }
 
-void ATransformerPawn::AddComponent_Internal(TArray<USceneComponent*>& OutComponentList
-	, USceneComponent* Component)
+void ATransformerPawn::AddSelectedRoot_Internal(USceneComponent* Component)
 {
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+	//A Selected Ancestor already moves this Component
+	if (IsCoveredBySelectedAncestor(Component)) return;
 
-	int32 Index = OutComponentList.Find(Component);
+	SelectedRoots.Add(Component);
+	if (SelectedRoots.Num() == 1) return;
 
-	if (INDEX_NONE == Index) //Component is not in list
+	//Roots below this Component are now moved by it
+	TArray<USceneComponent*> descendants;
+	Component->GetChildrenComponents(true, descendants);
+	for (USceneComponent* descendant : descendants)
 	{
-		OutComponentList.Emplace(Component);
-		bool bImplementsInterface;
-		Select(OutComponentList.Last(), &bImplementsInterface);
-		OnComponentSelectionChange(Component, true, bImplementsInterface);
+		if (SelectedRoots.Contains(descendant) && IsCoveredBySelectedAncestor(descendant))
+			SelectedRoots.Remove(descendant);
 	}
-	else if (bToggleSelectedInMultiSelection)
-		DeselectComponentAtIndex_Internal(OutComponentList, Index);
 }
 
-void ATransformerPawn::DeselectComponent_Internal(TArray<USceneComponent*>& OutComponentList
-	, USceneComponent* Component)
+void ATransformerPawn::RemoveSelectedRoot_Internal(USceneComponent* Component)
 {
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
+	if (!SelectedRoots.Remove(Component)) return;
 
-	int32 Index = OutComponentList.Find(Component);
-	if (INDEX_NONE != Index)
-		DeselectComponentAtIndex_Internal(OutComponentList, Index);
+	//Selected Descendants that were moved by this Component might be Roots now
+	TArray<USceneComponent*> descendants;
+	Component->GetChildrenComponents(true, descendants);
+	for (USceneComponent* descendant : descendants)
+	{
+		if (SelectedComponents.Contains(descendant) && !IsCoveredBySelectedAncestor(descendant))
+			SelectedRoots.Add(descendant);
+	}
 }
 
-void ATransformerPawn::DeselectComponentAtIndex_Internal(
-	TArray<USceneComponent*>& OutComponentList
-	, int32 Index)
+void ATransformerPawn::BeginSelectionBatch()
 {
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
-	if (OutComponentList.IsValidIndex(Index))
+	++SelectionBatchDepth;
+}
+
+void ATransformerPawn::EndSelectionBatch()
+{
+	if (SelectionBatchDepth <= 0)
 	{
-		USceneComponent* Component = OutComponentList[Index];
-		bool bImplementsInterface;
-		Deselect(Component, &bImplementsInterface);
-		OutComponentList.RemoveAt(Index);
-		OnComponentSelectionChange(Component, false, bImplementsInterface);
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("EndSelectionBatch called without a matching BeginSelectionBatch!"));
+		return;
+	}
+
+	//Only the outermost batch commits the changes
+	if (--SelectionBatchDepth > 0) return;
+
+	if (bGizmoPlacementPending)
+	{
+		bGizmoPlacementPending = false;
+		UpdateGizmoPlacement();
+	}
+
+	if (PendingAddedComponents.Num() > 0 || PendingRemovedComponents.Num() > 0)
+	{
+		//copy, as OnSelectionChanged could very well start another selection batch
+		TArray<USceneComponent*> addedComponents = PendingAddedComponents.GetArray();
+		TArray<USceneComponent*> removedComponents = PendingRemovedComponents.GetArray();
+		PendingAddedComponents.Empty();
+		PendingRemovedComponents.Empty();
+		OnSelectionChanged(addedComponents, removedComponents);
 	}
 
+	if (PendingAddedInstances.Num() > 0 || PendingRemovedInstances.Num() > 0)
+	{
+		TArray<FSelectedInstance> addedInstances = PendingAddedInstances.GetArray();
+		TArray<FSelectedInstance> removedInstances = PendingRemovedInstances.GetArray();
+		PendingAddedInstances.Empty();
+		PendingRemovedInstances.Empty();
+		OnInstanceSelectionChanged(addedInstances, removedInstances);
+	}
 }
 
 void ATransformerPawn::SetGizmo()
 {
+	//If there are no selected components, no gizmo should be active
+	UClass* GizmoClass = (SelectedComponents.Num() > 0 || SelectedInstances.Num() > 0) 
+		? GetGizmoClass(CurrentTransformation) : nullptr;
 
-	//If there are selected components, then we see whether we need to create a new gizmo.
-	if (SelectedComponents.Num() > 0)
-	{
-		bool bCreateGizmo = true;
-		if (Gizmo.IsValid())
-		{
-			if (CurrentTransformation == Gizmo->GetGizmoType())
-			{
-				bCreateGizmo = false; // do not create gizmo if there is already a matching gizmo
-			}
-			else
-			{
-				// Destroy the current gizmo as the transformation types do not match
-				Gizmo->Destroy();
-				Gizmo.Reset();
-			}
-		}
+	// do not change the gizmo if there is already a matching gizmo
+	if (Gizmo.IsValid() && Gizmo->GetClass() == GizmoClass)
+		return;
 
-		if (bCreateGizmo)
-		{
-			if (UWorld* world = GetWorld())
-			{
-				UClass* GizmoClass = GetGizmoClass(CurrentTransformation);
-				if (GizmoClass)
-				{
-					Gizmo = Cast<ABaseGizmo>(world->SpawnActor(GizmoClass));
-					Gizmo->OnGizmoStateChange.AddDynamic(this, &ATransformerPawn::OnGizmoStateChanged);
-				}
-			}
-		}
+	// Return the current gizmo to the pool as it does not match
+	if (Gizmo.IsValid())
+	{
+		Gizmo->SetGizmoEnabled(false);
+		Gizmo.Reset();
 	}
-	//Since there are no selected components, we must destroy any gizmos present
-	else
+
+	if (GizmoClass)
 	{
+		Gizmo = GetPooledGizmo(GizmoClass);
 		if (Gizmo.IsValid())
 		{
-			Gizmo->Destroy();
-			Gizmo.Reset();
+			Gizmo->SetTickWhileIdle(bTickWhileIdle);
+			Gizmo->SetHandleCollisionEnabled(!bAnalyticGizmoPicking);
+			Gizmo->SetGizmoEnabled(true);
 		}
 	}
+}
+
+ABaseGizmo* ATransformerPawn::GetPooledGizmo(UClass* GizmoClass)
+{
+	if (TWeakObjectPtr<ABaseGizmo>* pooledGizmo = GizmoPool.Find(GizmoClass))
+	{
+		if (pooledGizmo->IsValid())
+			return pooledGizmo->Get();
+	}
+
+	UWorld* world = GetWorld();
+	if (!world) return nullptr;
 
+	ABaseGizmo* newGizmo = Cast<ABaseGizmo>(world->SpawnActor(GizmoClass));
+	if (!newGizmo) return nullptr;
 
+	INC_DWORD_STAT(STAT_GizmoSpawns);
+	newGizmo->OnGizmoStateChange.AddDynamic(this, &ATransformerPawn::OnGizmoStateChanged);
+	newGizmo->OnGizmoHoverChange.AddDynamic(this, &ATransformerPawn::OnGizmoHoverChanged);
+	GizmoPool.Add(GizmoClass, newGizmo);
+	return newGizmo;
 }
 
 void ATransformerPawn::UpdateGizmoPlacement()
 {
+	//defer until the Selection Batch ends, so that the Gizmo is only updated once
+	if (IsInSelectionBatch())
+	{
+		bGizmoPlacementPending = true;
+		return;
+	}
+
 	SetGizmo();
+	//hovering keeps the Tick on only while there's a Gizmo
+	UpdateTickEnabled();
 	//means that there are no active gizmos (no selections) so nothing to do in this func
-	if (!Gizmo.IsValid()) return;
-
-	USceneComponent* ComponentToAttachTo = nullptr;
-
-	switch (GizmoPlacement)
+	if (!Gizmo.IsValid())
 	{
-	case EGizmoPlacement::GP_OnFirstSelection: 
-		ComponentToAttachTo = SelectedComponents[0]; break;
-	case EGizmoPlacement::GP_OnLastSelection:
-		ComponentToAttachTo = SelectedComponents.Last(); break;
+		//nothing left to transform if a drag was in progress
+		if (DragSession.bActive)
+			BeginDragSession();
+		return;
 	}
 
-	if (ComponentToAttachTo)
+	USceneComponent* ComponentToAttachTo = nullptr;
+
+	//Selected Components take precedence over Selected Instances
+	if (SelectedComponents.Num() > 0)
 	{
-		Gizmo->AttachToComponent(ComponentToAttachTo
-		, FAttachmentTransformRules::SnapToTargetIncludingScale);
+		switch (GizmoPlacement)
+		{
+		case EGizmoPlacement::GP_OnFirstSelection: 
+			ComponentToAttachTo = SelectedComponents.First(); break;
+		case EGizmoPlacement::GP_OnLastSelection:
+			ComponentToAttachTo = SelectedComponents.Last(); break;
+		}
 	}
 	else
 	{
-	//	Gizmo->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		switch (GizmoPlacement)
+		{
+		case EGizmoPlacement::GP_OnFirstSelection:
+			ComponentToAttachTo = PlaceInstanceGizmoAnchor(SelectedInstances.First()); break;
+		case EGizmoPlacement::GP_OnLastSelection:
+			ComponentToAttachTo = PlaceInstanceGizmoAnchor(SelectedInstances.Last()); break;
+		}
 	}
 
-	Gizmo->UpdateGizmoSpace(CurrentSpaceType);
+	//the Gizmo keeps its Space & Scale up to date from here on, whenever this Component moves
+	if (ComponentToAttachTo)
+		Gizmo->SetGizmoAttachParent(ComponentToAttachTo);
+
+	Gizmo->RefreshGizmoSpace(CurrentSpaceType);
+	//the Tick might be off while idle, so scale it right away
+	ScaleGizmoToLocalView();
+
+	//the Selection or Transformation changed mid-drag, so the snapshot needs to be retaken
+	if (DragSession.bActive)
+		BeginDragSession();
 }
 
 
@@ -993,6 +2847,24 @@ void ATransformerPawn::ReplicatedMouseTraceByObjectTypes(float TraceDistance
 	}
 }
 
+void ATransformerPawn::ReplicatedMarqueeSelect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd
+	, float TraceDistance, EMarqueeSelectionMode Mode)
+{
+	TArray<FPlane> frustumPlanes;
+	if (!GetMarqueeFrustumPlanes(ScreenStart, ScreenEnd, TraceDistance, frustumPlanes))
+		return;
+
+	//Server
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		SelectInFrustum(frustumPlanes, Mode);
+		ReplicateSelection();
+	}
+	//Client: only the Frustum is sent
+	else
+		ServerSelectInFrustum(frustumPlanes, Mode);
+}
+
 void ATransformerPawn::ReplicatedMouseTraceByChannel(float TraceDistance
 	, TEnumAsByte<ECollisionChannel> CollisionChannel, bool bAppendToList)
 {
@@ -1055,6 +2927,45 @@ void ATransformerPawn::ReplicatedMouseTraceByProfile(float TraceDistance
 
 
 
+void ATransformerPawn::ReplicatedAsyncMouseTraceByObjectTypes(float TraceDistance
+	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels, bool bAppendToList)
+{
+	FTransformerTraceQuery query;
+	if (GetMouseStartEndPoints(TraceDistance, query.StartLocation, query.EndLocation))
+	{
+		query.Type = ETraceQueryType::QT_ObjectTypes;
+		query.CollisionChannels = CollisionChannels;
+		query.bAppendToList = bAppendToList;
+		StartAsyncTrace(query, TArray<AActor*>(), EAsyncTraceStage::Replicated);
+	}
+}
+
+void ATransformerPawn::ReplicatedAsyncMouseTraceByChannel(float TraceDistance
+	, TEnumAsByte<ECollisionChannel> CollisionChannel, bool bAppendToList)
+{
+	FTransformerTraceQuery query;
+	if (GetMouseStartEndPoints(TraceDistance, query.StartLocation, query.EndLocation))
+	{
+		query.Type = ETraceQueryType::QT_Channel;
+		query.TraceChannel = CollisionChannel;
+		query.bAppendToList = bAppendToList;
+		StartAsyncTrace(query, TArray<AActor*>(), EAsyncTraceStage::Replicated);
+	}
+}
+
+void ATransformerPawn::ReplicatedAsyncMouseTraceByProfile(float TraceDistance
+	, const FName& ProfileName, bool bAppendToList)
+{
+	FTransformerTraceQuery query;
+	if (GetMouseStartEndPoints(TraceDistance, query.StartLocation, query.EndLocation))
+	{
+		query.Type = ETraceQueryType::QT_Profile;
+		query.ProfileName = ProfileName;
+		query.bAppendToList = bAppendToList;
+		StartAsyncTrace(query, TArray<AActor*>(), EAsyncTraceStage::Replicated);
+	}
+}
+
 TArray<AActor*> ATransformerPawn::GetIgnoredActorsForServerTrace() const
 {
 	TArray<AActor*> ignoredActors;
@@ -1069,13 +2980,13 @@ TArray<AActor*> ATransformerPawn::GetIgnoredActorsForServerTrace() const
 
 void ATransformerPawn::ReplicateServerTraceResults(bool bTraceSuccessful, bool bAppendToList)
 {
-	//Only perform this on Clients
-	if (!HasAuthority())
+	//Only the Server replicates (same as the ServerTraceBy RPCs)
+	if (HasAuthority())
 	{
 		if (!bTraceSuccessful && !bAppendToList)
 			DeselectAll(false);
-		MulticastSetDomain(CurrentDomain);
-		MulticastSetSelectedComponents(SelectedComponents);
+		ReplicateModeState();
+		ReplicateSelection();
 	}
 }
 
@@ -1085,9 +2996,10 @@ void ATransformerPawn::LogSelectedComponents()
 	UE_LOG(LogRuntimeTransformer, Log, TEXT("******************** SELECTED COMPONENTS LOG START ********************"));
     UE_LOG(LogRuntimeTransformer, Log, TEXT("   * Selected Component Count: %d"), SelectedComponents.Num());
     UE_LOG(LogRuntimeTransformer, Log, TEXT("   * -------------------------------- "));
-	for (int32 i = 0; i < SelectedComponents.Num(); ++i)
+	const TArray<USceneComponent*>& selectedComponents = SelectedComponents.GetArray();
+	for (int32 i = 0; i < selectedComponents.Num(); ++i)
 	{
-		USceneComponent* cmp = SelectedComponents[i];
+		USceneComponent* cmp = selectedComponents[i];
 		FString message = "Component: ";
 		if (cmp)
 		{
@@ -1122,97 +3034,337 @@ void ATransformerPawn::ServerTraceByObjectTypes_Implementation(
 	bool bTraceSuccessful = TraceByObjectTypes(StartLocation, EndLocation, CollisionChannels
 		, GetIgnoredActorsForServerTrace(), bAppendToList);
 
-	if (!bTraceSuccessful && !bAppendToList)
-		//check whether trace was successful and we're not doing multi selection
-		DeselectAll(false);
+	if (!bTraceSuccessful && !bAppendToList)
+		//check whether trace was successful and we're not doing multi selection
+		DeselectAll(false);
+
+	ReplicateModeState();
+	ReplicateSelection();
+}
+
+
+
+bool ATransformerPawn::ServerTraceByChannel_Validate(
+	const FVector& StartLocation, const FVector& EndLocation
+	, ECollisionChannel TraceChannel, bool bAppendToList)
+{
+	return true;
+}
+
+void ATransformerPawn::ServerTraceByChannel_Implementation(
+	const FVector& StartLocation, const FVector& EndLocation
+	, ECollisionChannel TraceChannel, bool bAppendToList)
+{
+	bool bTraceSuccessful = TraceByChannel(StartLocation, EndLocation, TraceChannel
+		, GetIgnoredActorsForServerTrace(), bAppendToList);
+
+	if (!bTraceSuccessful && !bAppendToList)
+		//check whether trace was successful and we're not doing multi selection
+		DeselectAll(false);
+
+	ReplicateModeState();
+	ReplicateSelection();
+}
+
+
+
+bool ATransformerPawn::ServerTraceByProfile_Validate(const FVector& StartLocation
+	, const FVector& EndLocation, const FName& ProfileName, bool bAppendToList) 
+{ 
+	return true; 
+}
+
+
+void ATransformerPawn::ServerTraceByProfile_Implementation(
+	const FVector& StartLocation, const FVector& EndLocation
+	, const FName& ProfileName, bool bAppendToList)
+{
+	bool bTraceSuccessful = TraceByProfile(StartLocation, EndLocation, ProfileName
+		, GetIgnoredActorsForServerTrace(), bAppendToList);
+
+	if (!bTraceSuccessful && !bAppendToList) 
+		//check whether trace was successful and we're not doing multi selection
+		DeselectAll(false); 
+
+	ReplicateModeState();
+	ReplicateSelection();
+}
+
+bool ATransformerPawn::ServerClearDomain_Validate() 
+{ 
+	return true; 
+}
+void ATransformerPawn::ServerClearDomain_Implementation()
+{
+	ClearDomain();
+	ReplicateModeState();
+}
+
+bool ATransformerPawn::ServerAsyncTrace_Validate(const FTransformerTraceQuery& Query)
+{
+	return Query.CollisionChannels.Num() <= ECC_MAX;
+}
+
+void ATransformerPawn::ServerAsyncTrace_Implementation(const FTransformerTraceQuery& Query)
+{
+	StartAsyncTrace(Query, GetIgnoredActorsForServerTrace(), EAsyncTraceStage::Server);
+}
+
+bool ATransformerPawn::ServerSelectInFrustum_Validate(const TArray<FPlane>& FrustumPlanes, EMarqueeSelectionMode Mode)
+{
+	//4 sides + far plane, and the near plane (a Volume with fewer Planes is unbounded)
+	if (FrustumPlanes.Num() < 5 || FrustumPlanes.Num() > 6)
+		return false;
+
+	for (const FPlane& plane : FrustumPlanes)
+	{
+		if (plane.ContainsNaN() || !FMath::IsFinite(plane.W) || !plane.IsNormalized())
+			return false;
+	}
+	return true;
+}
+
+void ATransformerPawn::ServerSelectInFrustum_Implementation(const TArray<FPlane>& FrustumPlanes, EMarqueeSelectionMode Mode)
+{
+	SelectInFrustum(FrustumPlanes, Mode);
+	ReplicateSelection();
+}
+
+bool ATransformerPawn::ServerApplyTransform_Validate(const FTransform& DeltaTransform)
+{
+	return true;
+}
+void ATransformerPawn::ServerApplyTransform_Implementation(const FTransform& DeltaTransform)
+{
+	MulticastApplyTransform(DeltaTransform);
+}
+
+void ATransformerPawn::MulticastApplyTransform_Implementation(const FTransform& DeltaTransform)
+{
+	if (Controller && !Controller->IsLocalController()) //only apply to others
+		ApplyDeltaTransform(DeltaTransform);
+}
+
+
+void ATransformerPawn::ReplicateFinishTransform()
+{
+	const bool bStreamed = bStreamDragTransforms && DragStreamSender.bStreaming;
+
+	//taken before the Drag Session ends, as Focusables that are not transformed (@see bTransformUFocusableObjects)
+	// never get to the Transforms the Drag left them with
+	TArray<FTransformerCommittedTransform> committedTransforms;
+	GatherCommittedTransforms(committedTransforms);
+
+	//the Commit below completes the Drag Stream
+	EndDragStream();
+	ClearDomain();
+
+	//the Domain is cleared first, so the remote Drag Sessions have ended before the Absolute Transforms are set
+	ServerClearDomain();
+	ReplicateTransformCommit(committedTransforms, bStreamed);
+	ResetDeltaTransform(NetworkDeltaTransform);
+}
+
+void ATransformerPawn::EndDragStream()
+{
+	if (!DragStreamSender.bStreaming) return;
+	DragStreamSender.End();
+	SET_DWORD_STAT(STAT_DragStreamBytesPerSecond, 0);
+}
+
+void ATransformerPawn::GatherCommittedTransforms(TArray<FTransformerCommittedTransform>& OutTransforms)
+{
+	OutTransforms.Reset();
+
+	if (DragSession.bActive)
+	{
+		//the Components have stayed in place while the Proxy was dragged
+		if (DragSession.bProxyActive && Gizmo.IsValid())
+			EvaluateDragSession();
 
-	MulticastSetDomain(CurrentDomain);
-	MulticastSetSelectedComponents(SelectedComponents);
-}
+		OutTransforms.Reserve(DragSession.Num());
+		for (int32 i = 0; i < DragSession.Num(); ++i)
+		{
+			if (IsValid(DragSession.Components[i]))
+				OutTransforms.Emplace(DragSession.Components[i], INDEX_NONE, DragSession.TargetTransforms.GetTransform(i));
+		}
 
+		for (const FTransformerInstanceBatch& batch : DragSession.InstanceBatches)
+		{
+			if (!IsValid(batch.InstancedMesh)) continue;
+			for (int32 i = 0; i < batch.InstanceIndices.Num(); ++i)
+				OutTransforms.Emplace(batch.InstancedMesh, batch.InstanceIndices[i], batch.TargetTransforms.GetTransform(i));
+		}
+		return;
+	}
 
+	//only the Roots: the Selected Descendants follow them through Attachment
+	for (USceneComponent* component : SelectedRoots.GetArray())
+	{
+		if (IsValid(component))
+			OutTransforms.Emplace(component, INDEX_NONE, component->GetComponentTransform());
+	}
 
-bool ATransformerPawn::ServerTraceByChannel_Validate(
-	const FVector& StartLocation, const FVector& EndLocation
-	, ECollisionChannel TraceChannel, bool bAppendToList)
-{
-	return true;
+	for (const FSelectedInstance& instance : SelectedInstances.GetArray())
+	{
+		FTransform instanceTransform;
+		if (IsValid(instance.Component)
+			&& instance.Component->GetInstanceTransform(instance.InstanceIndex, instanceTransform, true))
+			OutTransforms.Emplace(instance.Component, instance.InstanceIndex, instanceTransform);
+	}
 }
 
-void ATransformerPawn::ServerTraceByChannel_Implementation(
-	const FVector& StartLocation, const FVector& EndLocation
-	, ECollisionChannel TraceChannel, bool bAppendToList)
+void ATransformerPawn::ReplicateCancelTransform()
 {
-	bool bTraceSuccessful = TraceByChannel(StartLocation, EndLocation, TraceChannel
-		, GetIgnoredActorsForServerTrace(), bAppendToList);
+	const bool bStreamed = bStreamDragTransforms && DragStreamSender.bStreaming;
 
-	if (!bTraceSuccessful && !bAppendToList)
-		//check whether trace was successful and we're not doing multi selection
-		DeselectAll(false);
+	//the Commit below completes the Drag Stream
+	EndDragStream();
+	CancelTransform();
 
-	MulticastSetDomain(CurrentDomain);
-	MulticastSetSelectedComponents(SelectedComponents);
+	//everyone else moved with the Drag (Streamed or through Deltas), so they get the restored Transforms as a Commit
+	TArray<FTransformerCommittedTransform> restoredTransforms;
+	GatherCommittedTransforms(restoredTransforms);
+
+	ServerClearDomain();
+	ReplicateTransformCommit(restoredTransforms, bStreamed);
 }
 
+void ATransformerPawn::ReplicateTransformCommit(const TArray<FTransformerCommittedTransform>& Transforms, bool bStreamed)
+{
+	FTransformerTransformCommit commit;
+	commit.DragId = DragStreamSender.DragId;
+	commit.bStreamed = bStreamed;
 
+	const int32 chunkSize = FMath::Clamp(TransformCommitChunkSize, 1, 4096);
+	commit.Transforms.Reserve(FMath::Min(chunkSize, Transforms.Num()));
 
-bool ATransformerPawn::ServerTraceByProfile_Validate(const FVector& StartLocation
-	, const FVector& EndLocation, const FName& ProfileName, bool bAppendToList) 
-{ 
-	return true; 
-}
+	auto sendChunk = [this, &commit]()
+	{
+		//the Dragging Pawn takes the quantized Transforms as well, so that it ends up exactly like everyone else
+		commit.Quantize();
+		ApplyTransformCommit(commit);
+		ServerCommitTransforms(commit);
+		++commit.ChunkIndex;
+		commit.Transforms.Reset();
+	};
+
+	for (const FTransformerCommittedTransform& committed : Transforms)
+	{
+		commit.Transforms.Add(committed);
+		if (commit.Transforms.Num() == chunkSize)
+			sendChunk();
+	}
 
+	//at least one Chunk, so that a Streamed Drag is always completed
+	if (commit.Transforms.Num() > 0 || commit.ChunkIndex == 0)
+		sendChunk();
+}
 
-void ATransformerPawn::ServerTraceByProfile_Implementation(
-	const FVector& StartLocation, const FVector& EndLocation
-	, const FName& ProfileName, bool bAppendToList)
+void ATransformerPawn::ApplyTransformCommit(const FTransformerTransformCommit& Commit)
 {
-	bool bTraceSuccessful = TraceByProfile(StartLocation, EndLocation, ProfileName
-		, GetIgnoredActorsForServerTrace(), bAppendToList);
+	TArray<UInstancedStaticMeshComponent*, TInlineAllocator<4>> updatedInstancedMeshes;
 
-	if (!bTraceSuccessful && !bAppendToList) 
-		//check whether trace was successful and we're not doing multi selection
-		DeselectAll(false); 
+	for (const FTransformerCommittedTransform& committed : Commit.Transforms)
+	{
+		//not replicated (yet) or already destroyed here
+		if (!IsValid(committed.Component)) continue;
+
+		if (committed.InstanceIndex != INDEX_NONE)
+		{
+			UInstancedStaticMeshComponent* instancedMesh = Cast<UInstancedStaticMeshComponent>(committed.Component);
+			if (instancedMesh && instancedMesh->IsValidInstance(committed.InstanceIndex))
+			{
+				//the Render State is marked dirty once per Instanced Mesh below
+				instancedMesh->UpdateInstanceTransform(committed.InstanceIndex, committed.Transform, true, false, true);
+				updatedInstancedMeshes.AddUnique(instancedMesh);
+			}
+			continue;
+		}
+
+		if (committed.Component->Mobility != EComponentMobility::Type::Movable)
+		{
+			if (!bForceMobility) continue;
+			committed.Component->SetMobility(EComponentMobility::Type::Movable);
+		}
+		SetTransform(committed.Component, committed.Transform);
+	}
 
-	MulticastSetDomain(CurrentDomain);
-	MulticastSetSelectedComponents(SelectedComponents);
+	for (UInstancedStaticMeshComponent* instancedMesh : updatedInstancedMeshes)
+		instancedMesh->MarkRenderStateDirty();
+
+	FlushFocusableTransformations();
 }
 
-bool ATransformerPawn::ServerClearDomain_Validate() 
-{ 
-	return true; 
+bool ATransformerPawn::ServerStreamDragSample_Validate(const FTransformerDragSample& Sample)
+{
+	return true;
 }
-void ATransformerPawn::ServerClearDomain_Implementation()
+
+void ATransformerPawn::ServerStreamDragSample_Implementation(const FTransformerDragSample& Sample)
 {
-	MulticastClearDomain();
+	MulticastStreamDragSample(Sample);
 }
 
-void ATransformerPawn::MulticastClearDomain_Implementation()
+void ATransformerPawn::MulticastStreamDragSample_Implementation(const FTransformerDragSample& Sample)
 {
-	ClearDomain();
+	//the Dragging Pawn has already moved them
+	if (IsLocallyControlled()) return;
+
+	if (!DragStreamReceiver.Receive(Sample, FPlatformTime::Seconds(), 1.f / FMath::Max(DragStreamRate, 1.f)))
+	{
+		INC_DWORD_STAT(STAT_DroppedDragSamples);
+		return;
+	}
+
+	//the Drag Session is usually already there, begun when the Domain was replicated
+	if (!DragSession.bActive)
+	{
+		BeginDragSession();
+		DragStreamReceiver.bOwnsDragSession = true;
+	}
+	UpdateTickEnabled();
 }
 
-bool ATransformerPawn::ServerApplyTransform_Validate(const FTransform& DeltaTransform)
+bool ATransformerPawn::ServerCommitTransforms_Validate(const FTransformerTransformCommit& Commit)
 {
 	return true;
 }
-void ATransformerPawn::ServerApplyTransform_Implementation(const FTransform& DeltaTransform)
+
+void ATransformerPawn::ServerCommitTransforms_Implementation(const FTransformerTransformCommit& Commit)
 {
-	MulticastApplyTransform(DeltaTransform);
+	//a Client can only commit what it has Selected (same as the Delta, that only moved the Selection)
+	FTransformerTransformCommit selectedCommit = Commit;
+	selectedCommit.Transforms.RemoveAll([this](const FTransformerCommittedTransform& committed)
+	{
+		if (committed.InstanceIndex == INDEX_NONE)
+			return !SelectedComponents.Contains(committed.Component);
+		return !SelectedInstances.Contains(FSelectedInstance(
+			Cast<UInstancedStaticMeshComponent>(committed.Component), committed.InstanceIndex));
+	});
+
+	MulticastCommitTransforms(selectedCommit);
 }
 
-void ATransformerPawn::MulticastApplyTransform_Implementation(const FTransform& DeltaTransform)
+void ATransformerPawn::MulticastCommitTransforms_Implementation(const FTransformerTransformCommit& Commit)
 {
-	if (Controller && !Controller->IsLocalController()) //only apply to others
-		ApplyDeltaTransform(DeltaTransform);
-}
+	//the Dragging Pawn already has them
+	if (IsLocallyControlled()) return;
 
+	//the Drag Stream ends with the first Chunk, so that the late Samples are dropped from here on
+	if (Commit.bStreamed && Commit.ChunkIndex == 0)
+	{
+		if (DragStreamReceiver.bOwnsDragSession && DragSession.bActive)
+			EndDragSession();
+		DragStreamReceiver.Complete(Commit.DragId);
+		UpdateTickEnabled();
+	}
 
-void ATransformerPawn::ReplicateFinishTransform()
-{
-	ServerClearDomain();
-	ServerApplyTransform(NetworkDeltaTransform);
-	ResetDeltaTransform(NetworkDeltaTransform);
+	//the Mode State (with the cleared Domain) can arrive after the Commit, so the Drag Session is ended here
+	if (Commit.ChunkIndex == 0 && CurrentDomain != ETransformationDomain::TD_None)
+		ClearDomain();
+
+	ApplyTransformCommit(Commit);
 }
 
 bool ATransformerPawn::ServerDeselectAll_Validate(bool bDestroySelected) 
@@ -1234,28 +3386,19 @@ bool ATransformerPawn::ServerSetSpaceType_Validate(ESpaceType Space)
 	return true; 
 }
 void ATransformerPawn::ServerSetSpaceType_Implementation(ESpaceType Space)
-{
-	MulticastSetSpaceType(Space);
-}
-
-void ATransformerPawn::MulticastSetSpaceType_Implementation(ESpaceType Space)
 {
 	SetSpaceType(Space);
+	ReplicateModeState();
 }
 
-
 bool ATransformerPawn::ServerSetTransformationType_Validate(ETransformationType Transformation) 
 { 
 	return true; 
 }
 void ATransformerPawn::ServerSetTransformationType_Implementation(ETransformationType Transformation)
-{
-	MulticastSetTransformationType(Transformation);
-}
-
-void ATransformerPawn::MulticastSetTransformationType_Implementation(ETransformationType Transformation)
 {
 	SetTransformationType(Transformation);
+	ReplicateModeState();
 }
 
 bool ATransformerPawn::ServerSetComponentBased_Validate(bool bIsComponentBased) 
@@ -1263,13 +3406,9 @@ bool ATransformerPawn::ServerSetComponentBased_Validate(bool bIsComponentBased)
 	return true; 
 }
 void ATransformerPawn::ServerSetComponentBased_Implementation(bool bIsComponentBased)
-{
-	MulticastSetComponentBased(bIsComponentBased);
-}
-
-void ATransformerPawn::MulticastSetComponentBased_Implementation(bool bIsComponentBased)
 {
 	SetComponentBased(bIsComponentBased);
+	ReplicateModeState();
 }
 
 bool ATransformerPawn::ServerSetRotateOnLocalAxis_Validate(bool bRotateLocalAxis) 
@@ -1277,13 +3416,9 @@ bool ATransformerPawn::ServerSetRotateOnLocalAxis_Validate(bool bRotateLocalAxis
 	return true; 
 }
 void ATransformerPawn::ServerSetRotateOnLocalAxis_Implementation(bool bRotateLocalAxis)
-{
-	MulticastSetRotateOnLocalAxis(bRotateLocalAxis);
-}
-
-void ATransformerPawn::MulticastSetRotateOnLocalAxis_Implementation(bool bRotateLocalAxis)
 {
 	SetRotateOnLocalAxis(bRotateLocalAxis);
+	ReplicateModeState();
 }
 
 #include "TimerManager.h"
@@ -1310,50 +3445,16 @@ void ATransformerPawn::ServerCloneSelected_Implementation(bool bSelectNewClones
 	if (bSelectNewClones)
 	{
 		SelectMultipleComponents(CloneList, bAppendToList);
-		UnreplicatedComponentClones = CloneList;
 
-		//Timer to loop until all Unreplicated Actors have finished replicating!
-		if (UWorld* world = GetWorld())
+		//open the Actor Channels of the Clones as soon as possible, as Clients can't Select them before that
+		for (USceneComponent* clone : CloneList)
 		{
-			if (!CheckUnrepTimerHandle.IsValid())
-				world->GetTimerManager().SetTimer(CheckUnrepTimerHandle, this
-					, &ATransformerPawn::CheckUnreplicatedActors
-					, CloneReplicationCheckFrequency, true, 0.0f);
+			if (AActor* cloneOwner = clone ? clone->GetOwner() : nullptr)
+				cloneOwner->ForceNetUpdate();
 		}
-	}
-}
-
-void ATransformerPawn::CheckUnreplicatedActors()
-{
-
-	int32 RemoveCount = 0;
-	float timeElapsed = GetWorldTimerManager().GetTimerElapsed(CheckUnrepTimerHandle);
-	for (auto& c : UnreplicatedComponentClones)
-	{
-		// rather than calling "IsSupportedForNetworking" (which returns true all the time)
-		// call HasActorBegunPlay (which means we are sure the BeginPlay for AActor has finished completely.
-		// and so we can safely send this reference over the network.
-		if (c && c->HasBegunPlay() && c->IsSupportedForNetworking() &&
-			timeElapsed > MinimumCloneReplicationTime) // Make sure there's a minimum time...
-			++RemoveCount;
-	}
-
-	// Remove with performance (Swapping). We don't care about the order in this case
-	// since the role of this is to check that all unreplicated components have been replicated.
-	UnreplicatedComponentClones.RemoveAtSwap(0, RemoveCount);
-
-	// check if all clones have been replicated
-	if (UnreplicatedComponentClones.Num() == 0)
-	{
-		//stop calling this if no more unreplicated actors
-		GetWorldTimerManager().ClearTimer(CheckUnrepTimerHandle);
-
-		UE_LOG(LogRuntimeTransformer, Log, TEXT("[SERVER] Time Elapsed for %d Replicated Actors to replicate: %f")
-			, SelectedComponents.Num(), timeElapsed);
-
-		//send all the selected replicated actors!
-		MulticastSetSelectedComponents(SelectedComponents);
 
+		//Clients that don't have a Clone yet keep it as Missing, and Select it once it arrives
+		ReplicateSelection();
 	}
 }
 
@@ -1363,12 +3464,48 @@ bool ATransformerPawn::ServerSetDomain_Validate(ETransformationDomain Domain)
 }
 void ATransformerPawn::ServerSetDomain_Implementation(ETransformationDomain Domain)
 {
-	MulticastSetDomain(Domain);
+	SetDomain(Domain);
+	ReplicateModeState();
 }
 
-void ATransformerPawn::MulticastSetDomain_Implementation(ETransformationDomain Domain)
+void ATransformerPawn::ReplicateModeState()
 {
-	SetDomain(Domain);
+	FTransformerModeState modeState;
+	modeState.SpaceType				= CurrentSpaceType;
+	modeState.TransformationType	= CurrentTransformation;
+	modeState.Domain				= CurrentDomain;
+	modeState.bComponentBased		= bComponentBased;
+	modeState.bRotateOnLocalAxis	= bRotateOnLocalAxis;
+
+	//unchanged State is not even compared
+	if (modeState.SpaceType == ModeState.SpaceType
+		&& modeState.TransformationType == ModeState.TransformationType
+		&& modeState.Domain == ModeState.Domain
+		&& modeState.bComponentBased == ModeState.bComponentBased
+		&& modeState.bRotateOnLocalAxis == ModeState.bRotateOnLocalAxis)
+		return;
+
+	ModeState = modeState;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ATransformerPawn, ModeState, this);
+}
+
+void ATransformerPawn::OnRep_ModeState()
+{
+	//only what is different here is applied (late joiners get the whole State at once)
+	if (ModeState.bComponentBased != bComponentBased)
+		SetComponentBased(ModeState.bComponentBased);
+
+	if (ModeState.TransformationType != CurrentTransformation)
+		SetTransformationType(ModeState.TransformationType);
+
+	if (ModeState.SpaceType != CurrentSpaceType)
+		SetSpaceType(ModeState.SpaceType);
+
+	if (ModeState.bRotateOnLocalAxis != bRotateOnLocalAxis)
+		SetRotateOnLocalAxis(ModeState.bRotateOnLocalAxis);
+
+	if (ModeState.Domain != CurrentDomain && !IsLocallyControlled())
+		SetDomain(ModeState.Domain);
 }
 
 bool ATransformerPawn::ServerSyncSelectedComponents_Validate()
@@ -1377,7 +3514,7 @@ bool ATransformerPawn::ServerSyncSelectedComponents_Validate()
 }
 void ATransformerPawn::ServerSyncSelectedComponents_Implementation()
 {
-	MulticastSetSelectedComponents(SelectedComponents);
+	ReplicateSelectionSnapshot();
 }
 
 void ATransformerPawn::MulticastSetSelectedComponents_Implementation(
@@ -1389,24 +3526,17 @@ void ATransformerPawn::MulticastSetSelectedComponents_Implementation(
     }
 		
 
-	DeselectAll(); //calling here because Selecting MultipleComponents empty is not going to call Deselect all
-	SelectMultipleComponents(Components, true);
+	{
+		FScopedSelectionBatch selectionBatch(this);
+		DeselectAll(); //calling here because Selecting MultipleComponents empty is not going to call Deselect all
+		SelectMultipleComponents(Components, true);
+	}
 
 	//Tells whether we have Selected the exact number of components that came in 
 	// or there was a nullptr in Components and therefore there is a difference.
-	// if there is a difference we will need to resync
-	bResyncSelection = (Components.Num() != SelectedComponents.Num());
-	if (bResyncSelection)
-	{
-		//Timer to loop until all Unreplicated Actors have finished replicating!
-		if (UWorld* world = GetWorld())
-		{
-			if (!ResyncSelectionTimerHandle.IsValid())
-				world->GetTimerManager().SetTimer(ResyncSelectionTimerHandle, this
-					, &ATransformerPawn::ResyncSelection
-					, 0.1f, true, 0.0f);
-		}
-	}
+	// if there is a difference, a Snapshot (which keeps track of the Missing Components) is asked for
+	MissingSelection.Reset();
+	CheckSelectionCount(Components.Num(), true);
 	
 
 	if (GetLocalRole() < ROLE_Authority)
@@ -1416,19 +3546,309 @@ void ATransformerPawn::MulticastSetSelectedComponents_Implementation(
 		
 }
 
-void ATransformerPawn::ResyncSelection()
+void ATransformerPawn::ReplicateSelection()
+{
+	FTransformerSelectionDelta delta;
+
+	//only what changed since the last Delta / Snapshot
+	const TArray<USceneComponent*>& selectedComponents = SelectedComponents.GetArray();
+	for (USceneComponent* component : selectedComponents)
+	{
+		if (!ReplicatedSelection.Contains(component))
+			delta.Added.Add(component);
+	}
+	for (USceneComponent* component : ReplicatedSelection)
+	{
+		if (!SelectedComponents.Contains(component))
+			delta.Removed.Add(component);
+	}
+
+	for (USceneComponent* component : delta.Removed)
+		ReplicatedSelection.Remove(component);
+	ReplicatedSelection.Append(delta.Added);
+
+	INC_DWORD_STAT_BY(STAT_SelectionEntriesSent, delta.Added.Num() + delta.Removed.Num());
+
+	//even if nothing changed a Delta is sent, so the Clients can check their Selection Count against it
+	const int32 chunkSize = FMath::Clamp(SelectionChunkSize, 1, FTransformerSelectionDelta::MaxComponents);
+	if (delta.Added.Num() + delta.Removed.Num() <= chunkSize)
+	{
+		delta.BaseSequence = SelectionSequence;
+		delta.Sequence = ++SelectionSequence;
+		delta.SelectedCount = SelectedComponents.Num();
+		MulticastSelectionDelta(delta);
+		return;
+	}
+
+	//Added & Removed never share Components, so any split of them can be applied on its own (one Sequence each)
+	FTransformerSelectionDelta chunk;
+	auto sendChunk = [this, &chunk](bool bLastChunk)
+	{
+		chunk.BaseSequence = SelectionSequence;
+		chunk.Sequence = ++SelectionSequence;
+		chunk.SelectedCount = bLastChunk ? SelectedComponents.Num() : INDEX_NONE;
+		MulticastSelectionDelta(chunk);
+		chunk.Added.Reset();
+		chunk.Removed.Reset();
+	};
+
+	const int32 total = delta.Removed.Num() + delta.Added.Num();
+	for (int32 i = 0; i < total; ++i)
+	{
+		if (i < delta.Removed.Num())
+			chunk.Removed.Add(delta.Removed[i]);
+		else
+			chunk.Added.Add(delta.Added[i - delta.Removed.Num()]);
+
+		if (chunk.Added.Num() + chunk.Removed.Num() == chunkSize || i == total - 1)
+			sendChunk(i == total - 1);
+	}
+}
+
+void ATransformerPawn::ReplicateSelectionSnapshot()
+{
+	INC_DWORD_STAT(STAT_SelectionSnapshots);
+
+	const TArray<USceneComponent*>& selectedComponents = SelectedComponents.GetArray();
+	ReplicatedSelection.Reset();
+	ReplicatedSelection.Append(selectedComponents);
+
+	const int32 chunkSize = FMath::Clamp(SelectionChunkSize, 1, FTransformerSelectionDelta::MaxComponents);
+
+	FTransformerSelectionSnapshot snapshot;
+	snapshot.Sequence = ++SelectionSequence;
+	snapshot.ChunkCount = FMath::Max(1, FMath::DivideAndRoundUp(selectedComponents.Num(), chunkSize));
+
+	for (int32 chunkIndex = 0; chunkIndex < snapshot.ChunkCount; ++chunkIndex)
+	{
+		const int32 begin = chunkIndex * chunkSize;
+		const int32 count = FMath::Min(chunkSize, selectedComponents.Num() - begin);
+
+		snapshot.ChunkIndex = chunkIndex;
+		snapshot.Components.Reset();
+		if (count > 0)
+			snapshot.Components.Append(selectedComponents.GetData() + begin, count);
+
+		INC_DWORD_STAT_BY(STAT_SelectionEntriesSent, snapshot.Components.Num());
+		MulticastSelectionSnapshot(snapshot);
+	}
+}
+
+void ATransformerPawn::MulticastSelectionDelta_Implementation(const FTransformerSelectionDelta& Delta)
+{
+	//the Server Selection is the one being replicated
+	if (HasAuthority()) return;
+
+	if (bAwaitingSelectionSnapshot) return;
+
+	//a Delta was missed (e.g. we joined late): everything is resent as a Snapshot
+	if (Delta.BaseSequence != ReceivedSelectionSequence)
+	{
+		RequestSelectionSnapshot();
+		return;
+	}
+
+	ApplySelectionChange(Delta.Added, Delta.Removed);
+	ReceivedSelectionSequence = Delta.Sequence;
+
+	//Removed Components that did resolve could have been Missing until now
+	TArray<FNetworkGUID> unresolvedRemoved = Delta.UnresolvedRemoved;
+	if (MissingSelection.Num() > 0)
+	{
+		UNetDriver* netDriver = GetNetDriver();
+		if (netDriver && netDriver->GuidCache.IsValid())
+		{
+			for (USceneComponent* component : Delta.Removed)
+			{
+				if (component)
+					unresolvedRemoved.Add(netDriver->GuidCache->GetNetGUID(component));
+			}
+		}
+	}
+	UpdateMissingSelection(Delta.UnresolvedAdded, unresolvedRemoved);
+
+	if (Delta.SelectedCount != INDEX_NONE)
+		CheckSelectionCount(Delta.SelectedCount, true);
+}
+
+void ATransformerPawn::MulticastSelectionSnapshot_Implementation(const FTransformerSelectionSnapshot& Snapshot)
+{
+	if (HasAuthority()) return;
+
+	if (Snapshot.ChunkIndex == 0)
+	{
+		PendingSelectionSnapshot.Reset();
+		PendingSnapshotUnresolved.Reset();
+	}
+	PendingSelectionSnapshot.Append(Snapshot.Components);
+	PendingSnapshotUnresolved.Append(Snapshot.UnresolvedComponents);
+
+	if (Snapshot.ChunkIndex < Snapshot.ChunkCount - 1)
+		return;
+
+	//only the difference with the current Selection is applied
+	TSet<USceneComponent*> snapshotComponents;
+	snapshotComponents.Reserve(PendingSelectionSnapshot.Num());
+	for (USceneComponent* component : PendingSelectionSnapshot)
+	{
+		if (component)
+			snapshotComponents.Add(component);
+	}
+
+	TArray<USceneComponent*> added, removed;
+	for (USceneComponent* component : snapshotComponents)
+	{
+		if (!SelectedComponents.Contains(component))
+			added.Add(component);
+	}
+	for (USceneComponent* component : SelectedComponents.GetArray())
+	{
+		if (!snapshotComponents.Contains(component))
+			removed.Add(component);
+	}
+
+	ApplySelectionChange(added, removed);
+	ReceivedSelectionSequence = Snapshot.Sequence;
+	bAwaitingSelectionSnapshot = false;
+
+	MissingSelection.Reset();
+	UpdateMissingSelection(PendingSnapshotUnresolved, TArray<FNetworkGUID>());
+
+	//another Snapshot would come with the same Components, so it's not asked for again
+	CheckSelectionCount(PendingSelectionSnapshot.Num(), false);
+	PendingSelectionSnapshot.Reset();
+	PendingSnapshotUnresolved.Reset();
+}
+
+void ATransformerPawn::ApplySelectionChange(const TArray<USceneComponent*>& Added
+	, const TArray<USceneComponent*>& Removed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ApplySelectionChange);
+
+	if (Added.Num() == 0 && Removed.Num() == 0) return;
+
+	FScopedSelectionBatch selectionBatch(this);
+	for (USceneComponent* component : Removed)
+	{
+		if (component)
+			DeselectComponent_Internal(component);
+	}
+
+	//could have been Selected locally already (e.g. by the Local Trace), which must not toggle it
+	for (USceneComponent* component : Added)
+	{
+		if (component && !SelectedComponents.Contains(component))
+			AddComponent_Internal(component);
+	}
+	UpdateGizmoPlacement();
+}
+
+void ATransformerPawn::CheckSelectionCount(int32 ServerSelectedCount, bool bCanRequestSnapshot)
 {
-	if (bResyncSelection)
+	//Missing Components are already accounted for, and Selected as they arrive
+	const int32 selectedCount = SelectedComponents.Num() + MissingSelection.Num();
+	if (ServerSelectedCount == selectedCount) return;
+
+	if (bCanRequestSnapshot)
 	{
-        UE_LOG(LogRuntimeTransformer,Warning, TEXT("Resyncing Selection"));
-		ServerSyncSelectedComponents();
+		UE_LOG(LogRuntimeTransformer, Log, TEXT("Selection Count mismatch (Server: %d, Client: %d). Requesting Snapshot")
+			, ServerSelectedCount, selectedCount);
+		RequestSelectionSnapshot();
 	}
 	else
 	{
-        UE_LOG(LogRuntimeTransformer, Warning, TEXT("Resyncing FINISHED"));
-		//stop calling this if no more resync is needed
-		GetWorldTimerManager().ClearTimer(ResyncSelectionTimerHandle);
+		//e.g. Components that are not Supported for Networking, which can't ever be Selected here
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("%d Selected Components of the Server can't be resolved")
+			, ServerSelectedCount - selectedCount);
+	}
+}
+
+void ATransformerPawn::RequestSelectionSnapshot()
+{
+	if (bAwaitingSelectionSnapshot) return;
+	bAwaitingSelectionSnapshot = true;
+	ServerSyncSelectedComponents();
+}
+
+void ATransformerPawn::UpdateMissingSelection(const TArray<FNetworkGUID>& Unresolved
+	, const TArray<FNetworkGUID>& UnresolvedRemoved)
+{
+	for (const FNetworkGUID& netGUID : UnresolvedRemoved)
+		MissingSelection.Remove(netGUID);
+
+	//a Component that is still Missing keeps the time it went Missing
+	const double now = FPlatformTime::Seconds();
+	for (const FNetworkGUID& netGUID : Unresolved)
+	{
+		if (!MissingSelection.Contains(netGUID))
+			MissingSelection.Add(netGUID, now);
+	}
+
+	UWorld* world = GetWorld();
+	if (world && MissingSelection.Num() > 0 && !world->GetTimerManager().IsTimerActive(MissingSelectionRetryHandle))
+	{
+		world->GetTimerManager().SetTimer(MissingSelectionRetryHandle, this, &ATransformerPawn::ResolveMissingSelection
+			, MissingSelectionRetryInterval, true);
+	}
+
+	SET_DWORD_STAT(STAT_MissingSelection, MissingSelection.Num());
+}
+
+void ATransformerPawn::OnActorSpawned(AActor* Actor)
+{
+	if (MissingSelection.Num() == 0 || bResolveMissingSelectionPending) return;
+
+	//Spawned Replicated Actors get registered in the Package Map right after spawning
+	if (UWorld* world = GetWorld())
+	{
+		bResolveMissingSelectionPending = true;
+		world->GetTimerManager().SetTimerForNextTick(this, &ATransformerPawn::ResolveMissingSelection);
+	}
+}
+
+void ATransformerPawn::ResolveMissingSelection()
+{
+	bResolveMissingSelectionPending = false;
+
+	UNetDriver* netDriver = GetNetDriver();
+	if (!netDriver || !netDriver->GuidCache.IsValid()) return;
+
+	const double now = FPlatformTime::Seconds();
+	TArray<USceneComponent*> resolved;
+	for (auto it = MissingSelection.CreateIterator(); it; ++it)
+	{
+		UObject* object = netDriver->GuidCache->GetObjectFromNetGUID(it->Key, false);
+		if (USceneComponent* component = Cast<USceneComponent>(object))
+		{
+			resolved.Add(component);
+			it.RemoveCurrent();
+		}
+		else if (netDriver->GuidCache->IsGUIDBroken(it->Key, false))
+		{
+			UE_LOG(LogRuntimeTransformer, Warning, TEXT("Missing Selected Component %s can't be resolved")
+				, *it->Key.ToString());
+			it.RemoveCurrent();
+		}
+		else if (now - it->Value > MissingSelectionTimeout)
+		{
+			UE_LOG(LogRuntimeTransformer, Warning, TEXT("Missing Selected Component %s did not arrive in %.1f seconds")
+				, *it->Key.ToString(), MissingSelectionTimeout);
+			it.RemoveCurrent();
+		}
+	}
+
+	if (MissingSelection.Num() == 0)
+	{
+		if (UWorld* world = GetWorld())
+			world->GetTimerManager().ClearTimer(MissingSelectionRetryHandle);
+	}
+
+	if (resolved.Num() > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_MissingSelectionResolved, resolved.Num());
+		ApplySelectionChange(resolved, TArray<USceneComponent*>());
 	}
+	SET_DWORD_STAT(STAT_MissingSelection, MissingSelection.Num());
 }
 
 #undef RTT_LOG
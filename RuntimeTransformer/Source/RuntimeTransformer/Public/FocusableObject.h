@@ -35,4 +35,26 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Focusable")
 	void OnNewTransformation(class ATransformerPawn* Caller, class USceneComponent* Component, const FTransform& NewTransform, bool bComponentBased);
 
+	/**
+	 * Batched version of OnNewTransformation. Called (at most) once per frame with every Component of this Focusable Object
+	 * that got a new Transform in that frame (e.g. all the Selected Components of an Actor, if Actor Based).
+	 * Only called if WantsBatchedTransformations returns true, in which case OnNewTransformation is NOT called.
+	 * By default, calls OnNewTransformation for each Component.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Focusable")
+	void OnNewTransformations(class ATransformerPawn* Caller, const TArray<class USceneComponent*>& Components
+		, const TArray<FTransform>& NewTransforms, bool bComponentBased);
+
+	virtual void OnNewTransformations_Implementation(class ATransformerPawn* Caller, const TArray<class USceneComponent*>& Components
+		, const TArray<FTransform>& NewTransforms, bool bComponentBased);
+
+	/**
+	 * Whether this Focusable Object wants OnNewTransformations (once per frame) instead of OnNewTransformation (once per Component).
+	 * Asked only once, when the Focusable Object gets Selected. False by default.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Focusable")
+	bool WantsBatchedTransformations() const;
+
+	virtual bool WantsBatchedTransformations_Implementation() const;
+
 };
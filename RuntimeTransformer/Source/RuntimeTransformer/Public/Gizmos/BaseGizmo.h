@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
 #include "RuntimeTransformer.h"
 #include "BaseGizmo.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FGizmoStateChangedDelegate, ETransformationType, GizmoType, bool, bTransformInProgress, ETransformationDomain, CurrentDomain);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGizmoHoverChangedDelegate, ETransformationType, GizmoType, ETransformationDomain, HoveredDomain);
 
 UCLASS()
 class RUNTIMETRANSFORMER_API ABaseGizmo : public AActor
@@ -24,6 +26,18 @@ public:
 
 	virtual void UpdateGizmoSpace(ESpaceType SpaceType);
 
+	/**
+	 * Calls UpdateGizmoSpace only if the Space Type changed since the last call, or the Gizmo got attached to something else.
+	 * Movements of the Attach Parent are handled by the Gizmo itself (@see SetGizmoAttachParent)
+	 */
+	void RefreshGizmoSpace(ESpaceType SpaceType);
+
+	/**
+	 * Attaches the Gizmo to the given Component (detaches it if null) and listens to its Transform Updates
+	 * so that the Gizmo Space and Scale are only recalculated when the Attach Parent moves, instead of every frame.
+	 */
+	void SetGizmoAttachParent(class USceneComponent* AttachParent);
+
 	//Base Gizmo does not affect anything and returns No Delta Transform.
 	// This func is overriden by each Transform Gizmo
 	virtual FTransform GetDeltaTransform(const FVector& LookingVector, const FVector& RayStartPoint
@@ -36,12 +50,31 @@ public:
 	 * @param Reference Location - The Location of where the Gizmo is seen (i.e. Camera Location)
 	 * @param Reference Look Direction - the direction the reference is looking (i.e. Camera Look Direction)
 	 * @param FieldOfView - Field of View of Camera, in Degrees
+	 * Skipped if the Reference moved less than the Camera Tolerances and the Gizmo did not move since the last call.
 	*/
 	void ScaleGizmoScene(const FVector& ReferenceLocation, const FVector& ReferenceLookDirection, float FieldOfView = 90.f);
 
 	UFUNCTION(BlueprintCallable, Category = "Gizmo")
 	ETransformationDomain GetTransformationDomain(class USceneComponent* ComponentHit) const;
 
+	/**
+	 * Tests the Ray against the Handles of the Gizmo (the registered Domain Components) in closed form,
+	 * so it works without Physics (i.e. even with the Gizmo Collision disabled).
+	 * Boxes and Spheres are supported, and each Gizmo class can override how its Handles are tested (e.g. Rotation Rings).
+	 * @return the Domain of the Handle closest to RayStart, or None if no Handle was hit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	ETransformationDomain TraceDomain(const FVector& RayStart, const FVector& RayEnd) const;
+
+	/**
+	 * Updates the Hovered Domain with the Handle under the given Ray (@see TraceDomain).
+	 * Calls OnGizmoHoverChange if the Hovered Domain changed.
+	 */
+	void UpdateHoveredDomain(const FVector& RayStart, const FVector& RayEnd);
+
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	ETransformationDomain GetHoveredDomain() const { return HoveredDomain; }
+
 	// Returns a Snapped Transform based on how much has been accumulated, the Delta Transform and Snapping Value
 	// Also changes the Accumulated Transform based on how much was snapped
 	virtual FTransform GetSnappedTransform(FTransform& outCurrentAccumulatedTransform
@@ -70,6 +103,15 @@ protected:
 	//should be called at the end of the GetDeltaTransformation Implemenation
 	void UpdateRays(const FVector& RayStart, const FVector& RayEnd);
 
+	/**
+	 * Closed-form Ray test against a single Handle, in the Local Space of the Handle.
+	 * The Ray is LocalRayStart + Time * LocalRayDirection, with Time in [0, 1]
+	 * @param outTime - Time of the first hit along the Ray. Same for Local and World Space, so it can be compared between Handles
+	 * @return whether the Handle was hit
+	 */
+	virtual bool IntersectHandle(const class UShapeComponent* Handle, ETransformationDomain Domain
+		, const FVector& LocalRayStart, const FVector& LocalRayDirection, float& outTime) const;
+
 	/**
 	 * Adds or modifies an entry to the DomainMap.
 	*/
@@ -86,6 +128,29 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Gizmo")
 	bool GetTransformProgressState() const { return bTransformInProgress; }
 
+	/**
+	 * Enables/Disables the Gizmo (Visibility, Collision & Tick) so that it can be pooled and reused
+	 * instead of being Destroyed and Spawned again.
+	 * When disabled, the Gizmo is detached and its Transform Progress State is reset (without broadcasting),
+	 * as if it had been freshly spawned.
+	 */
+	virtual void SetGizmoEnabled(bool bEnabled);
+
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	bool IsGizmoEnabled() const { return bGizmoEnabled; }
+
+	/**
+	 * Whether the Handles of the Gizmo have Collision (true by default).
+	 * Can be disabled if the Handles are only picked with TraceDomain, so the Gizmo has no Physics Bodies to rescale.
+	 */
+	void SetHandleCollisionEnabled(bool bEnabled);
+
+	/**
+	 * Whether the Gizmo ticks while it has nothing to update (true by default).
+	 * The Gizmo does not need to tick to work: it only ticks to fix its attachment right after being attached.
+	 */
+	void SetTickWhileIdle(bool bInTickWhileIdle);
+
 	/**
 	 * Delegate that is called when the Transform State is changed (when it changes from
 	 * in progress = true to false (and viceversa)
@@ -94,6 +159,13 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Gizmo")
 	FGizmoStateChangedDelegate OnGizmoStateChange;
 
+	/**
+	 * Delegate that is called when the Domain under the Cursor changes (@see UpdateHoveredDomain)
+	 * Can be used to highlight the Handle that would be picked
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Gizmo")
+	FGizmoHoverChangedDelegate OnGizmoHoverChange;
+
 protected:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gizmo")
@@ -128,13 +200,58 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gizmo")
 	float CameraArcRadius;
 
+	/* How much the Camera has to move (in units) for the Gizmo Scene to be scaled again. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gizmo", meta = (ClampMin = "0"))
+	float CameraLocationTolerance;
+
+	/* How much the Camera has to turn or change its Field of View (in degrees) for the Gizmo Scene to be scaled again. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gizmo", meta = (ClampMin = "0"))
+	float CameraAngleTolerance;
+
 private:
+
+	void OnAttachParentTransformUpdated(class USceneComponent* UpdatedComponent
+		, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	//Ticks only while there is something to do (or always, if bTickWhileIdle)
+	void UpdateTickEnabled();
+
+	//The Component the Gizmo is attached to, and the handle of its Transform Updated binding
+	TWeakObjectPtr<class USceneComponent> GizmoAttachParent;
+	FDelegateHandle AttachParentTransformHandle;
+
+	//Inputs of the last ScaleGizmoScene call
+	FVector LastReferenceLocation;
+	FVector LastReferenceLookDirection;
+	float LastFieldOfView;
+
+	//Space Type of the last RefreshGizmoSpace call
+	ESpaceType LastSpaceType;
+
+	//Whether the Gizmo Scene Scale/Space need to be recalculated regardless of their inputs (e.g. the Gizmo moved)
+	bool bGizmoSceneScaleDirty;
+	bool bGizmoSpaceDirty;
+
+	//The Root Scene has to be snapped again to its Attach Parent (on the next Tick) after attaching
+	bool bAttachmentSnapPending;
+
+	bool bTickWhileIdle;
+
 	// Maps the Box Component to their Respective Domain
 	TMap<class UShapeComponent*, ETransformationDomain> DomainMap;
 
 	//Whether Transform is in Progress or Not 
 	bool bTransformInProgress;
 
+	//Whether the Gizmo is currently in use (false when it's waiting in the pool)
+	bool bGizmoEnabled;
+
+	//Whether the Handles collide when the Gizmo is enabled
+	bool bHandleCollisionEnabled;
+
+	//The Domain of the Handle under the Cursor (@see UpdateHoveredDomain)
+	ETransformationDomain HoveredDomain;
+
 protected:
 
 	//bool to check whether the PrevRay vectors have been set
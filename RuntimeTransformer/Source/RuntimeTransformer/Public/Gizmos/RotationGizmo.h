@@ -37,6 +37,14 @@ protected:
 		, const FVector& RayEndPoint
 		,  ETransformationDomain Domain) override;
 
+	//Axis Boxes are tested as Rings: flat on the thinnest side of the Box, as wide as the smallest of the other two sides
+	virtual bool IntersectHandle(const class UShapeComponent* Handle, ETransformationDomain Domain
+		, const FVector& LocalRayStart, const FVector& LocalRayDirection, float& outTime) const override;
+
+	/* Inner Radius of the Rotation Rings, relative to their Outer Radius (0 means the Rings are full Discs). Only used by TraceDomain */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gizmo", meta = (ClampMin = "0", ClampMax = "1"))
+	float RingInnerRadiusRatio;
+
 private:
 
 	FVector PreviousRotationViewScale;
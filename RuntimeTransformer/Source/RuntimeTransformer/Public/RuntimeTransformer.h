@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
 #include "RuntimeTransformer.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogRuntimeTransformer, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("RuntimeTransformer"), STATGROUP_RuntimeTransformer, STATCAT_Advanced);
+
 UENUM(BlueprintType)
 enum class ETransformationType : uint8
 {
@@ -42,6 +45,23 @@ enum class ETransformationDomain : uint8
 
 };
 
+UENUM(BlueprintType)
+enum class EMarqueeSelectionMode : uint8
+{
+	MS_Replace			UMETA(DisplayName = "Replace"),		//Selects what is in the Marquee, deselecting everything else
+	MS_Add				UMETA(DisplayName = "Add"),			//Selects what is in the Marquee, keeping the previous Selection
+	MS_Subtract			UMETA(DisplayName = "Subtract"),	//Deselects what is in the Marquee
+	MS_Intersect		UMETA(DisplayName = "Intersect"),	//Deselects what is NOT in the Marquee
+};
+
+UENUM(BlueprintType)
+enum class ETraceQueryType : uint8
+{
+	QT_ObjectTypes		UMETA(DisplayName = "Object Types"),
+	QT_Channel			UMETA(DisplayName = "Channel"),
+	QT_Profile			UMETA(DisplayName = "Profile"),
+};
+
 class FRuntimeTransformerModule : public IModuleInterface
 {
 public:
@@ -0,0 +1,149 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "UObject/ObjectKey.h"
+
+class UPrimitiveComponent;
+struct FConvexVolume;
+
+//A Component hit by FSelectionIndex::Raycast
+struct FSelectionIndexHit
+{
+	UPrimitiveComponent* Component;
+
+	//Where the Component was hit along the Ray, from 0 (Ray Start) to 1 (Ray End)
+	float Time;
+};
+
+/**
+ * Bounding Volume Hierarchy (dynamic AABB tree) of Selectable Components that does not depend on Collision,
+ * so that Components can be picked without having Collision at all (@see ATransformerPawn::RegisterSelectable).
+ *
+ * Leaves keep Fat Bounds (Bounds expanded by BoundsMargin) so that Components moving a little are not reinserted.
+ * Components are followed through their TransformUpdated event, so the Index keeps itself up to date.
+ * The tree is balanced with rotations every time a Leaf is inserted or removed.
+ *
+ * Rays are tested against the Fat World Bounds first (broad phase), and then against the Local Bounds
+ * of each Component, in its Local Space (narrow phase), which is an oriented & tighter box.
+ *
+ * Components are kept by Object Key, so an Object later allocated at the address of a destroyed Component is a new Leaf.
+ * Leaves of destroyed Components are skipped by the Queries, and removed when a Query runs into them
+ * (on the next change to the Index) or by RemoveStaleLeaves.
+ */
+class RUNTIMETRANSFORMER_API FSelectionIndex
+{
+public:
+
+	FSelectionIndex();
+	~FSelectionIndex();
+
+	//Components are bound to this very instance, so it cannot be copied
+	FSelectionIndex(const FSelectionIndex&) = delete;
+	FSelectionIndex& operator=(const FSelectionIndex&) = delete;
+
+	/**
+	 * Adds the Component to the Index.
+	 * @return false if the Component is not valid or was already in the Index
+	 */
+	bool Add(UPrimitiveComponent* Component);
+
+	/**
+	 * Removes the Component from the Index.
+	 * @return false if the Component was not in the Index
+	 */
+	bool Remove(UPrimitiveComponent* Component);
+
+	bool Contains(const UPrimitiveComponent* Component) const;
+
+	//Includes the destroyed Components that have not been removed yet (@see RemoveStaleLeaves)
+	int32 Num() const { return LeafMap.Num(); }
+
+	//Removes the Leaves of every destroyed Component
+	void RemoveStaleLeaves();
+
+	void Reset();
+
+	//Reinserts the Component if it moved out of its Fat Bounds. Called automatically when the Component moves
+	void Update(UPrimitiveComponent* Component);
+
+	/**
+	 * Finds the Components hit by the Segment from RayStart to RayEnd, sorted from closest to farthest.
+	 * Components that were destroyed while in the Index are skipped.
+	 * @param bFirstHitOnly - whether only the closest hit is wanted (far less of the tree is visited)
+	 */
+	void Raycast(const FVector& RayStart, const FVector& RayEnd
+		, TArray<FSelectionIndexHit>& outHits, bool bFirstHitOnly = false) const;
+
+	/**
+	 * Finds the Components whose Bounds intersect the Convex Volume (e.g. a Frustum).
+	 * Planes are tested 4 at a time with SIMD (@see FConvexVolume::IntersectBox), and whole subtrees
+	 * fully inside the Volume are gathered without testing their Leaves.
+	 * @param Volume - must have been initialized (@see FConvexVolume::Init)
+	 */
+	void QueryConvexVolume(const FConvexVolume& Volume, TArray<UPrimitiveComponent*>& outComponents) const;
+
+	//Height of the tree (0 if empty or a single Leaf)
+	int32 GetHeight() const;
+
+	//How much the Leaf Bounds are expanded on each side
+	float BoundsMargin;
+
+private:
+
+	typedef TObjectKey<UPrimitiveComponent> FComponentKey;
+
+	struct FNode
+	{
+		FBox Bounds;
+		int32 Parent;
+		int32 Left;
+		int32 Right;
+
+		//0 for Leaves
+		int32 Height;
+
+		/* Leaves only */
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FComponentKey ComponentKey;
+		FBox LocalBounds;
+		FDelegateHandle TransformUpdatedHandle;
+
+		bool IsLeaf() const { return Left == INDEX_NONE; }
+	};
+
+	//Adds every valid Component under the Node
+	void GatherLeaves(int32 NodeIndex, TArray<UPrimitiveComponent*>& outComponents) const;
+
+	int32 AllocateNode();
+	void FreeNode(int32 NodeIndex);
+
+	void InsertLeaf(int32 Leaf);
+	void RemoveLeaf(int32 Leaf);
+
+	//Rotates the Node with its taller child if they are unbalanced. Returns the Node that took its place
+	int32 Balance(int32 NodeIndex);
+
+	void OnComponentTransformUpdated(USceneComponent* UpdatedComponent
+		, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	//Removes the Leaf (if it still is the Leaf of a destroyed Component)
+	void RemoveStaleLeaf(int32 Leaf);
+
+	//Removes the Stale Leaves the Queries ran into
+	void RemoveFoundStaleLeaves();
+
+	TArray<FNode> Nodes;
+	int32 Root;
+
+	//Free Nodes are linked through their Parent index
+	int32 FreeList;
+
+	//Leaf of each Component
+	TMap<FComponentKey, int32> LeafMap;
+
+	//Leaves of destroyed Components the (const) Queries ran into, removed on the next change to the Index
+	mutable TSet<int32> FoundStaleLeaves;
+};
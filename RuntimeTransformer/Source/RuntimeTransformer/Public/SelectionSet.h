@@ -0,0 +1,152 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Ordered Set used to store Selections.
+ * Membership, Insertion and Removal are O(1) (amortized), while still keeping the order
+ * in which the elements were added (crucial for the Gizmo Placement on First/Last Selection).
+ *
+ * Removing an element only marks its slot as removed. The removed slots are compacted lazily
+ * (when too many have piled up or when the contiguous view is requested),
+ * so the Array returned by GetArray() never contains removed elements.
+ */
+template<typename ElementType>
+class TSelectionSet
+{
+public:
+
+	TSelectionSet()
+		: RemovedCount(0)
+		, FirstAliveIndex(0)
+	{
+	}
+
+	int32 Num() const { return IndexMap.Num(); }
+
+	bool Contains(const ElementType& Element) const { return IndexMap.Contains(Element); }
+
+	void Reserve(int32 Number)
+	{
+		Elements.Reserve(Number);
+		IndexMap.Reserve(Number);
+	}
+
+	/**
+	 * Adds the Element at the end of the Set.
+	 * @return false if the Element was already in the Set (nothing is done in that case)
+	 */
+	bool Add(const ElementType& Element)
+	{
+		if (IndexMap.Contains(Element)) return false;
+
+		IndexMap.Add(Element, Elements.Num());
+		Elements.Add(Element);
+		AliveFlags.Add(true);
+		return true;
+	}
+
+	/**
+	 * Removes the Element from the Set while keeping the order of the rest of elements.
+	 * @return false if the Element was not in the Set
+	 */
+	bool Remove(const ElementType& Element)
+	{
+		int32 Index;
+		if (!IndexMap.RemoveAndCopyValue(Element, Index)) return false;
+
+		AliveFlags[Index] = false;
+		++RemovedCount;
+
+		//Pop all the removed slots at the end, so that Last() never has to skip anything
+		while (Elements.Num() > 0 && !AliveFlags[Elements.Num() - 1])
+		{
+			Elements.Pop(false);
+			AliveFlags.RemoveAt(AliveFlags.Num() - 1);
+			--RemovedCount;
+		}
+
+		if (IndexMap.Num() == 0)
+		{
+			Empty();
+			return true;
+		}
+
+		//move the First Alive Index forward if we removed the first element
+		while (FirstAliveIndex < Elements.Num() && !AliveFlags[FirstAliveIndex])
+			++FirstAliveIndex;
+
+		//Compact when there are more removed slots than alive elements, so that compaction cost stays amortized O(1)
+		if (RemovedCount > IndexMap.Num())
+			Compact();
+
+		return true;
+	}
+
+	void Empty()
+	{
+		Elements.Reset();
+		AliveFlags.Empty();
+		IndexMap.Reset();
+		RemovedCount = 0;
+		FirstAliveIndex = 0;
+	}
+
+	//Gets the first element that was added. Set must not be empty
+	const ElementType& First() const
+	{
+		check(Num() > 0);
+		return Elements[FirstAliveIndex];
+	}
+
+	//Gets the last element that was added. Set must not be empty
+	const ElementType& Last() const
+	{
+		check(Num() > 0);
+		return Elements.Last();
+	}
+
+	/**
+	 * Gets a Read-Only Contiguous view of the Set, in the order the elements were added.
+	 * The reference is valid until the Set is modified.
+	 */
+	const TArray<ElementType>& GetArray() const
+	{
+		Compact();
+		return Elements;
+	}
+
+private:
+
+	//Removes all the removed slots and recalculates the indices of the elements moved
+	void Compact() const
+	{
+		if (RemovedCount == 0) return;
+
+		int32 WriteIndex = 0;
+		for (int32 ReadIndex = 0; ReadIndex < Elements.Num(); ++ReadIndex)
+		{
+			if (!AliveFlags[ReadIndex]) continue;
+			if (WriteIndex != ReadIndex)
+			{
+				Elements[WriteIndex] = Elements[ReadIndex];
+				IndexMap.FindChecked(Elements[WriteIndex]) = WriteIndex;
+			}
+			++WriteIndex;
+		}
+
+		Elements.SetNum(WriteIndex, false);
+		AliveFlags.Init(true, WriteIndex);
+		RemovedCount = 0;
+		FirstAliveIndex = 0;
+	}
+
+	//Compaction can take place in a const context (GetArray), which is why these are mutable
+	mutable TArray<ElementType> Elements;
+	mutable TBitArray<> AliveFlags;
+	mutable TMap<ElementType, int32> IndexMap;
+	mutable int32 RemovedCount;
+	mutable int32 FirstAliveIndex;
+};
@@ -0,0 +1,254 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "TransformerMath.h"
+
+/**
+ * Instances of the Drag Proxy that share the same Static Mesh (one Instanced Static Mesh Component per mesh).
+ * Index i of the arrays refers to the same instance.
+ */
+struct FTransformerDragProxyBatch
+{
+	class UInstancedStaticMeshComponent* InstancedMesh;
+
+	//Index (in the Drag Session) of the Component that moves each instance
+	TArray<int32> SessionIndices;
+
+	//Start Transform of each instance relative to the Start Transform of its Drag Session Component 
+	// (or relative to the Proxy Root, if the Proxy is Rigid)
+	TArray<FTransform> RelativeTransforms;
+
+	//Scratch for the per-frame World Transforms, to avoid allocating every frame
+	TArray<FTransform> WorldTransforms;
+};
+
+//Transforms waiting to be delivered to a Focusable Object that wants them in batches (IFocusableObject::OnNewTransformations)
+struct FPendingFocusableTransformations
+{
+	TArray<class USceneComponent*> Components;
+	TArray<FTransform> Transforms;
+};
+
+/**
+ * Selected Instances of a single Instanced Static Mesh Component being dragged.
+ * Instances are updated with one BatchUpdateInstancesTransforms call per run of consecutive Instance Indices,
+ * and the Render State is only marked dirty once per frame.
+ */
+struct FTransformerInstanceBatch
+{
+	FTransformerInstanceBatch()
+		: InstancedMesh(nullptr)
+		, bRestoreAutoRebuildTree(false)
+	{
+	}
+
+	class UInstancedStaticMeshComponent* InstancedMesh;
+
+	//Index i of these refers to the same Selected Instance, sorted by Instance Index
+	TArray<int32> InstanceIndices;
+	FTransformSoA StartTransforms;
+	FTransformSoA TargetTransforms;
+
+	//Start Transforms (by Instance Index) from before a mid-drag retake, restored on Cancel
+	TMap<int32, FTransform> OriginalStartTransforms;
+
+	//End (exclusive) of each run of consecutive Instance Indices, so that every run is written with a single update
+	// and the Instances in between (which might have changed since the drag started) are left untouched
+	TArray<int32> RunEnds;
+	TArray<FTransform> RunTransforms;
+
+	//Whether the Instanced Mesh is Hierarchical and had its Tree Auto Rebuild enabled before the drag
+	bool bRestoreAutoRebuildTree;
+};
+
+/**
+ * Snapshot of the Selected Components taken when a Transform (Drag) starts.
+ * Every frame, the new transforms are calculated from the Start Transforms + the Total Delta accumulated
+ * since the drag began (rather than re-reading the Components and adding a per-frame delta), so that
+ * no error is accumulated and the original state can be restored if the drag is cancelled.
+ *
+ * Data is stored as Structure of Arrays: index i of every array refers to the same Component.
+ */
+struct FTransformerDragSession
+{
+	FTransformerDragSession()
+		: bActive(false)
+		, bOverlapsDeferred(false)
+		, bSingleDelta(false)
+		, bNavigationDeferred(false)
+		, bProxyActive(false)
+		, bProxyRigid(false)
+		, ProxyAnchorIndex(INDEX_NONE)
+		, GizmoStartLocation(FVector::ZeroVector)
+		, TargetVersion(0)
+		, CommitCursor(0)
+		, VisibleCommitCursor(0)
+		, CommitBacklog(0)
+		, CommitLapStartTime(0.0)
+		, PreviousCommitLapStartTime(0.0)
+		, LastBudgetedCommitFrame(0)
+		, AnchorInstanceBatch(INDEX_NONE)
+		, AnchorInstanceSlot(INDEX_NONE)
+	{
+	}
+
+	int32 Num() const { return Components.Num(); }
+
+	void Reset()
+	{
+		bActive = false;
+		bOverlapsDeferred = false;
+		bSingleDelta = false;
+		bNavigationDeferred = false;
+		bProxyActive = false;
+		bProxyRigid = false;
+		ProxyAnchorIndex = INDEX_NONE;
+		TargetVersion = 0;
+		CommitCursor = 0;
+		VisibleCommitCursor = 0;
+		CommitBacklog = 0;
+		CommitLapStartTime = 0.0;
+		PreviousCommitLapStartTime = 0.0;
+		LastBudgetedCommitFrame = 0;
+		AnchorInstanceBatch = INDEX_NONE;
+		AnchorInstanceSlot = INDEX_NONE;
+		GizmoStartLocation = FVector::ZeroVector;
+		TotalDeltaTransform = FTransform();
+		TotalDeltaTransform.SetScale3D(FVector::ZeroVector);
+
+		//keep the memory, as it is very likely the next drag has the same amount of components
+		Components.Reset();
+		Focusables.Reset();
+		StartTransforms.Reset();
+		StartMobilities.Reset();
+		TargetTransforms.Reset();
+
+		SimulatedBodies.Reset();
+		SimulatedLinearVelocities.Reset();
+		SimulatedAngularVelocities.Reset();
+		NavigationComponents.Reset();
+		NavigationCounts.Reset();
+		ProxyBatches.Reset();
+		ProxyHiddenMeshes.Reset();
+		CommittedVersions.Reset();
+		CommitPriority.Reset();
+		InstanceBatches.Reset();
+		OriginalStartTransforms.Reset();
+	}
+
+	void Add(class USceneComponent* Component, class UObject* Focusable
+		, const FTransform& StartTransform, EComponentMobility::Type StartMobility)
+	{
+		Components.Add(Component);
+		Focusables.Add(Focusable);
+		StartTransforms.Add(StartTransform);
+		StartMobilities.Add(StartMobility);
+		TargetTransforms.Add(StartTransform);
+		//the Start Transform is what the Component already has
+		CommittedVersions.Add(TargetVersion);
+	}
+
+	//Whether a drag is currently taking place
+	bool bActive;
+
+	//Whether the Components are being moved without updating their Overlaps (reconciled when the drag ends)
+	bool bOverlapsDeferred;
+
+	//Whether this session only lasts for a single Delta (e.g. a replicated one without a Domain)
+	bool bSingleDelta;
+
+	//Whether the Navigation Components have been removed from the Navigation for the drag
+	bool bNavigationDeferred;
+
+	//Whether a Proxy is being dragged instead of the Components (see ATransformerPawn::ProxyDragThreshold)
+	bool bProxyActive;
+
+	/**
+	 * Whether the whole Proxy moves as a single rigid body (Translation & Rotation around the Gizmo),
+	 * so that only the Proxy Root has to be moved. Otherwise each instance is moved.
+	 */
+	bool bProxyRigid;
+
+	//The Drag Session Component the Gizmo is attached to. It is not proxied, as the Gizmo must follow it
+	int32 ProxyAnchorIndex;
+
+	TArray<FTransformerDragProxyBatch> ProxyBatches;
+
+	//The Static Meshes replaced by Proxy instances. They are hidden while dragging
+	TArray<class UStaticMeshComponent*> ProxyHiddenMeshes;
+
+	//Where the Gizmo was when the drag started. Used as the Pivot for the Rotations
+	FVector GizmoStartLocation;
+
+	//The Delta Transform accumulated since the drag started (Rotations are composed, Locations and Scales are added)
+	FTransform TotalDeltaTransform;
+
+	TArray<class USceneComponent*> Components;
+
+	//The UFocusable Object of each Component (nullptr if it does not implement it)
+	TArray<class UObject*> Focusables;
+
+	//Laid out for the SIMD kernel (@see FTransformerMath::ApplyDeltaTransform)
+	FTransformSoA StartTransforms;
+
+	//Mobility before the drag started (carried over mid-drag retakes), restored on Cancel
+	TArray<TEnumAsByte<EComponentMobility::Type>> StartMobilities;
+
+	/**
+	 * Start Transforms from before a mid-drag retake, restored on Cancel, for the Components that stayed Selected.
+	 * StartTransforms are retaken (as the Total Delta starts over), so they no longer are where the drag started.
+	 */
+	TMap<class USceneComponent*, FTransform> OriginalStartTransforms;
+
+	//The Transforms calculated for the current frame, waiting to be committed to the Components
+	FTransformSoA TargetTransforms;
+
+	//Bodies that were Simulating Physics when the drag started. They are kinematic for the drag
+	TArray<class UPrimitiveComponent*> SimulatedBodies;
+
+	//Velocities of the Simulated Bodies when the drag started, restored when it finishes
+	TArray<FVector> SimulatedLinearVelocities;
+	TArray<FVector> SimulatedAngularVelocities;
+
+	//Components (Roots & their Children) that affected Navigation when the drag started. 
+	// They are removed from Navigation for the drag and added back when it finishes
+	TArray<class USceneComponent*> NavigationComponents;
+
+	//How many of the Navigation Components each Component moves (only set while the Navigation is deferred)
+	TArray<int32> NavigationCounts;
+
+	//Incremented every time the Target Transforms are evaluated
+	uint32 TargetVersion;
+
+	//The Target Version each Component was last committed with. Up to date when it matches TargetVersion
+	TArray<uint32> CommittedVersions;
+
+	//Order in which the Components are committed when on a Frame Budget (closest to the camera first)
+	TArray<int32> CommitPriority;
+
+	//Position in CommitPriority where the next round-robin catch-up starts
+	int32 CommitCursor;
+
+	//Position in CommitPriority where the next pass over the recently rendered Components starts
+	int32 VisibleCommitCursor;
+
+	//How many Components are out of date. Kept as they are evaluated & committed, so it never needs a full scan
+	int32 CommitBacklog;
+
+	//When (in seconds) the current and the previous round-robin laps over CommitPriority started
+	double CommitLapStartTime;
+	double PreviousCommitLapStartTime;
+
+	//Frame of the last Budgeted commit, to not spend the Budget twice in the same frame
+	uint64 LastBudgetedCommitFrame;
+
+	//Selected Instances being dragged, one batch per Instanced Static Mesh Component
+	TArray<FTransformerInstanceBatch> InstanceBatches;
+
+	//Instance Batch & Slot of the Instance the Gizmo is placed on (if the Gizmo is placed on an Instance)
+	int32 AnchorInstanceBatch;
+	int32 AnchorInstanceSlot;
+};
@@ -0,0 +1,59 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Transforms stored as Structure of Arrays (one array per float channel)
+ * so that they can be processed in SIMD blocks.
+ */
+struct RUNTIMETRANSFORMER_API FTransformSoA
+{
+	int32 Num() const { return LocationX.Num(); }
+
+	void SetNum(int32 Number);
+	void Reset();
+	void Add(const FTransform& Transform);
+
+	void SetTransform(int32 Index, const FTransform& Transform);
+	FTransform GetTransform(int32 Index) const;
+	FVector GetLocation(int32 Index) const { return FVector(LocationX[Index], LocationY[Index], LocationZ[Index]); }
+
+	TArray<float> LocationX, LocationY, LocationZ;
+	TArray<float> RotationX, RotationY, RotationZ, RotationW;
+	TArray<float> ScaleX, ScaleY, ScaleZ;
+};
+
+/**
+ * Standalone math used by the Transformer Pawn, working on plain data (no World, no UObjects)
+ * so that it can be tested and benchmarked on its own.
+ */
+struct RUNTIMETRANSFORMER_API FTransformerMath
+{
+	/**
+	 * Applies a (Total) Delta Transform to the Start Transforms in the range [BeginIndex, EndIndex).
+	 * For each Transform:
+	 *  - Location is rotated around the Pivot by the Delta Rotation (unless bRotateOnLocalAxis) and offset by the Delta Location
+	 *  - Rotation is composed with the Delta Rotation
+	 *  - Delta Scale is unrotated to the Local Space of the Transform and added to its Scale
+	 *
+	 * Processes blocks of 4 Transforms with SIMD registers, and falls back to the scalar path for the remainder.
+	 * outTransforms must be at least as big as StartTransforms.
+	 */
+	static void ApplyDeltaTransform(const FTransformSoA& StartTransforms, FTransformSoA& outTransforms
+		, int32 BeginIndex, int32 EndIndex
+		, const FTransform& DeltaTransform, const FVector& Pivot, bool bRotateOnLocalAxis);
+
+	//Same as ApplyDeltaTransform, but one Transform at a time with FQuat/FVector operations. Used as Reference & Fallback
+	static void ApplyDeltaTransform_Scalar(const FTransformSoA& StartTransforms, FTransformSoA& outTransforms
+		, int32 BeginIndex, int32 EndIndex
+		, const FTransform& DeltaTransform, const FVector& Pivot, bool bRotateOnLocalAxis);
+
+	/**
+	 * Slab Test of the Segment RayStart + Time * RayDirection (Time in [0, 1]) against the Box.
+	 * @param outTime - where the Segment enters the Box (0 if it starts inside)
+	 * @return whether the Segment hits the Box
+	 */
+	static bool IntersectRayBox(const FVector& RayStart, const FVector& RayDirection, const FBox& Box, float& outTime);
+};
@@ -0,0 +1,355 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/NetworkGuid.h"
+#include "RuntimeTransformer.h"
+#include "TransformerNetTypes.generated.h"
+
+//Quantization shared by the compact Network Types of the Transformer Pawn
+struct RUNTIMETRANSFORMER_API FTransformerNetQuantize
+{
+	/**
+	 * Serializes a Quaternion as its 3 smallest components (15 bits each) + the index of the largest one (2 bits).
+	 * The largest component is rebuilt from the others, as the Quaternion is normalized.
+	 * Serializing a Quaternion that was received gives back the exact same values, so it can be relayed as it is.
+	 */
+	static void SerializeQuat(FQuat& Quat, FArchive& Ar);
+};
+
+/**
+ * A sample of the Delta Transform accumulated by a Drag in progress, sent unreliably while dragging
+ * (@see ATransformerPawn::bStreamDragTransforms).
+ * Location & Scale are quantized and Rotation compressed. Rotation & Scale are only sent if the Drag changed them.
+ */
+USTRUCT()
+struct RUNTIMETRANSFORMER_API FTransformerDragSample
+{
+	GENERATED_BODY()
+
+	FTransformerDragSample()
+		: DragId(0)
+		, Sequence(0)
+		, DeltaTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector)
+	{
+	}
+
+	FTransformerDragSample(uint8 InDragId, uint16 InSequence, const FTransform& InDeltaTransform)
+		: DragId(InDragId)
+		, Sequence(InSequence)
+		, DeltaTransform(InDeltaTransform)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	//How many Bytes this Sample takes once Net Serialized (without the RPC overhead)
+	int32 GetSerializedSize() const;
+
+	//Drag this Sample belongs to. Incremented by the Dragging Pawn every time a Drag starts
+	uint8 DragId;
+
+	//Incremented with every Sample of the Drag, so that Samples arriving out of order are dropped
+	uint16 Sequence;
+
+	//The Delta Transform accumulated since the Drag started
+	FTransform DeltaTransform;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerDragSample> : public TStructOpsTypeTraitsBase2<FTransformerDragSample>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+//Absolute Transform of a Component (or of one of its Instances) once a Drag has finished
+struct FTransformerCommittedTransform
+{
+	FTransformerCommittedTransform()
+		: Component(nullptr)
+		, InstanceIndex(INDEX_NONE)
+	{
+	}
+
+	FTransformerCommittedTransform(class USceneComponent* InComponent, int32 InInstanceIndex, const FTransform& InTransform)
+		: Component(InComponent)
+		, InstanceIndex(InInstanceIndex)
+		, Transform(InTransform)
+	{
+	}
+
+	//Sent as its Network GUID. nullptr if it could not be resolved (e.g. not replicated yet)
+	class USceneComponent* Component;
+
+	//Index of the Instance, if the Component is an Instanced Static Mesh. INDEX_NONE for the Component itself
+	int32 InstanceIndex;
+
+	//World Transform
+	FTransform Transform;
+};
+
+/**
+ * The Absolute Transforms a Drag left the Selection with, sent reliably when the Drag finishes
+ * (@see ATransformerPawn::ReplicateFinishTransform), so that everyone ends up with the exact same Transforms
+ * regardless of their Gizmo, Snapping or float error.
+ * Large Selections are split into several Commits (Chunks). Each Chunk can be applied on its own.
+ * Locations are quantized to 1 decimal, Rotations compressed and Scales packed (unit Scales take a single bit).
+ */
+USTRUCT()
+struct RUNTIMETRANSFORMER_API FTransformerTransformCommit
+{
+	GENERATED_BODY()
+
+	FTransformerTransformCommit()
+		: DragId(0)
+		, bStreamed(false)
+		, ChunkIndex(0)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	//Sets the Transforms to what they will be once received (i.e. after the quantization)
+	void Quantize();
+
+	//The Drag that was Streamed (if bStreamed), so the Drag Stream can be completed
+	uint8 DragId;
+	bool bStreamed;
+
+	uint16 ChunkIndex;
+
+	TArray<FTransformerCommittedTransform> Transforms;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerTransformCommit> : public TStructOpsTypeTraitsBase2<FTransformerTransformCommit>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * The Mode of a Transformer Pawn, replicated as a single Property (@see ATransformerPawn::ReplicateModeState)
+ * so that late joiners get it too. Only the members that changed are sent, without a Reliable RPC per change.
+ * The payload bits of each member are reported by RuntimeTransformer.NetTypes.ModeState (not compared against the old RPCs).
+ * It is Push Based: only compared when marked Dirty if the Engine is built WITH_PUSH_MODEL and net.IsPushModelEnabled is 1.
+ * Otherwise it is compared every time the Pawn is considered for replication, like any other Property.
+ */
+USTRUCT()
+struct RUNTIMETRANSFORMER_API FTransformerModeState
+{
+	GENERATED_BODY()
+
+	FTransformerModeState()
+		: SpaceType(ESpaceType::ST_World)
+		, TransformationType(ETransformationType::TT_Translation)
+		, Domain(ETransformationDomain::TD_None)
+		, bComponentBased(false)
+		, bRotateOnLocalAxis(false)
+	{
+	}
+
+	UPROPERTY()
+	ESpaceType SpaceType;
+
+	UPROPERTY()
+	ETransformationType TransformationType;
+
+	UPROPERTY()
+	ETransformationDomain Domain;
+
+	UPROPERTY()
+	uint8 bComponentBased : 1;
+
+	UPROPERTY()
+	uint8 bRotateOnLocalAxis : 1;
+};
+
+/**
+ * A change of the Selection of the Server, replicated as the Components Added & Removed since BaseSequence
+ * (@see ATransformerPawn::ReplicateSelection). Receivers that are not at BaseSequence ask for a Snapshot instead.
+ * Large changes are split into several Deltas, each moving the Sequence by one.
+ * Components that can't be resolved yet by the Receiver (e.g. Clones whose Actor Channel isn't open yet)
+ * arrive as nullptr, and their Network GUIDs are kept so they can be resolved once they arrive.
+ */
+USTRUCT()
+struct RUNTIMETRANSFORMER_API FTransformerSelectionDelta
+{
+	GENERATED_BODY()
+
+	FTransformerSelectionDelta()
+		: BaseSequence(0)
+		, Sequence(0)
+		, SelectedCount(INDEX_NONE)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	//Upper bound of the Components a single Delta / Snapshot can carry
+	static constexpr int32 MaxComponents = 4096;
+
+	UPROPERTY()
+	uint32 BaseSequence;
+
+	UPROPERTY()
+	uint32 Sequence;
+
+	//How many Components the Server has Selected once this Delta is applied. INDEX_NONE if more Deltas follow
+	UPROPERTY()
+	int32 SelectedCount;
+
+	UPROPERTY()
+	TArray<class USceneComponent*> Added;
+
+	UPROPERTY()
+	TArray<class USceneComponent*> Removed;
+
+	//[Receiver] Network GUIDs of the Added / Removed Components that could not be resolved
+	TArray<FNetworkGUID> UnresolvedAdded;
+	TArray<FNetworkGUID> UnresolvedRemoved;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerSelectionDelta> : public TStructOpsTypeTraitsBase2<FTransformerSelectionDelta>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * The whole Selection of the Server at Sequence, sent when a Receiver is out of sync.
+ * Large Selections are split into several Chunks, applied once the last one arrives.
+ */
+USTRUCT()
+struct RUNTIMETRANSFORMER_API FTransformerSelectionSnapshot
+{
+	GENERATED_BODY()
+
+	FTransformerSelectionSnapshot()
+		: Sequence(0)
+		, ChunkIndex(0)
+		, ChunkCount(1)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	UPROPERTY()
+	uint32 Sequence;
+
+	UPROPERTY()
+	int32 ChunkIndex;
+
+	UPROPERTY()
+	int32 ChunkCount;
+
+	UPROPERTY()
+	TArray<class USceneComponent*> Components;
+
+	//[Receiver] Network GUIDs of the Components that could not be resolved
+	TArray<FNetworkGUID> UnresolvedComponents;
+};
+
+template<>
+struct TStructOpsTypeTraits<FTransformerSelectionSnapshot> : public TStructOpsTypeTraitsBase2<FTransformerSelectionSnapshot>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+//The Dragging side of the Drag Stream
+struct FTransformerDragStreamSender
+{
+	FTransformerDragStreamSender()
+		: bStreaming(false)
+		, DragId(0)
+		, Sequence(0)
+		, LastSendTime(0.0)
+		, WindowStartTime(0.0)
+		, WindowBytes(0)
+		, BytesPerSecond(0.f)
+	{
+	}
+
+	//Starts a new Drag (if not streaming already)
+	void Begin();
+
+	//Stops the Drag, which needs a Begin to stream again
+	void End();
+
+	//Adds the Bytes sent to the current window, refreshing BytesPerSecond every second
+	void AddSentBytes(int32 Bytes, double Time);
+
+	bool bStreaming;
+	uint8 DragId;
+	uint16 Sequence;
+	double LastSendTime;
+
+	double WindowStartTime;
+	int32 WindowBytes;
+	float BytesPerSecond;
+};
+
+/**
+ * The Receiving side of the Drag Stream. Interpolates from the Delta shown when a Sample arrives
+ * to the Delta of that Sample, over the time it took for the Sample to arrive after the previous one.
+ */
+struct FTransformerDragStreamReceiver
+{
+	FTransformerDragStreamReceiver()
+		: bActive(false)
+		, bOwnsDragSession(false)
+		, DragId(0)
+		, LatestSequence(0)
+		, bHasCompletedDrag(false)
+		, CompletedDragId(0)
+		, LatestTime(0.0)
+		, Duration(0.f)
+	{
+		ResetDeltas();
+	}
+
+	/**
+	 * Takes the Sample if it is newer than the latest one of the active Drag (or starts a new Drag).
+	 * @param DefaultDuration - how long to interpolate to the first Sample of a Drag
+	 * @return false if the Sample is stale and was dropped
+	 */
+	bool Receive(const FTransformerDragSample& Sample, double Time, float DefaultDuration);
+
+	//The Delta Transform to show at the given Time
+	FTransform Evaluate(double Time) const;
+
+	//Finishes the Drag. Late Samples of it will be dropped
+	void Complete(uint8 InDragId);
+
+	void ResetDeltas();
+
+	bool bActive;
+
+	//Whether the Drag Session was begun by the Stream (rather than by the Domain being replicated)
+	bool bOwnsDragSession;
+
+	uint8 DragId;
+	uint16 LatestSequence;
+
+	bool bHasCompletedDrag;
+	uint8 CompletedDragId;
+
+	FTransform PreviousDelta;
+	FTransform LatestDelta;
+
+	//When the Latest Sample arrived, and how long to take from the Previous to the Latest Delta
+	double LatestTime;
+	float Duration;
+};
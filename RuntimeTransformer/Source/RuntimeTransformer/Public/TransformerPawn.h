@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
 #include "RuntimeTransformer.h"
+#include "SelectionSet.h"
+#include "TransformerDragSession.h"
+#include "SelectionIndex.h"
+#include "TransformerNetTypes.h"
+#include "WorldCollision.h"
 #include "TransformerPawn.generated.h"
 
 UENUM(BlueprintType)
@@ -15,29 +20,153 @@ enum class EGizmoPlacement : uint8
 	GP_OnLastSelection		UMETA(DisplayName = "On Last Selection"),
 };
 
+/**
+ * A single Instance of an Instanced Static Mesh Component (e.g. Foliage, HISMs)
+ * that has been selected on its own.
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMETRANSFORMER_API FSelectedInstance
+{
+	GENERATED_BODY()
+
+	FSelectedInstance()
+		: Component(nullptr)
+		, InstanceIndex(INDEX_NONE)
+	{
+	}
+
+	FSelectedInstance(class UInstancedStaticMeshComponent* InComponent, int32 InInstanceIndex)
+		: Component(InComponent)
+		, InstanceIndex(InInstanceIndex)
+	{
+	}
+
+	bool operator==(const FSelectedInstance& Other) const
+	{
+		return Component == Other.Component && InstanceIndex == Other.InstanceIndex;
+	}
+
+	friend uint32 GetTypeHash(const FSelectedInstance& SelectedInstance)
+	{
+		return HashCombine(GetTypeHash(SelectedInstance.Component), GetTypeHash(SelectedInstance.InstanceIndex));
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	class UInstancedStaticMeshComponent* Component;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Transformer")
+	int32 InstanceIndex;
+};
+
+/**
+ * Everything needed to run a Selection Trace later (@see ATransformerPawn::AsyncMouseTraceByChannel),
+ * or somewhere else (e.g. in the Server).
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMETRANSFORMER_API FTransformerTraceQuery
+{
+	GENERATED_BODY()
+
+	FTransformerTraceQuery()
+		: Type(ETraceQueryType::QT_Channel)
+		, StartLocation(FVector::ZeroVector)
+		, EndLocation(FVector::ZeroVector)
+		, TraceChannel(ECC_Visibility)
+		, ProfileName(NAME_None)
+		, bAppendToList(false)
+	{
+	}
+
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	ETraceQueryType Type;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	FVector StartLocation;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	FVector EndLocation;
+
+	//Only used by Object Types Queries
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels;
+
+	//Only used by Channel Queries
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	TEnumAsByte<ECollisionChannel> TraceChannel;
+
+	//Only used by Profile Queries
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	FName ProfileName;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	bool bAppendToList;
+};
+
+//What is left to do once an Async Trace completes
+enum class EAsyncTraceStage : uint8
+{
+	//Same as the MouseTrace functions
+	Local,
+
+	//Same as the ReplicatedMouseTrace functions (Server Trace follows if nothing local was hit)
+	Replicated,
+
+	//Same as the ServerTrace functions (Results are multicast)
+	Server,
+};
+
 UCLASS()
 class RUNTIMETRANSFORMER_API ATransformerPawn : public APawn
 {
 	GENERATED_BODY()
 
+	//The Automation Tests time (and drive) the private Drag Session & Transform Commit steps directly
+	friend struct FTransformerPawnTestAccess;
+
 public:
 	// Sets default values for this actor's properties
 	ATransformerPawn();
 	virtual void GetLifetimeReplicatedProps(
 		TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/*
+	 * Initializes the Mode State (in the Server) and listens for Replicated Actors arriving (in Clients),
+	 * to resolve the Selection still missing
+	 */
+	virtual void BeginPlay() override;
+
+	//Ends the Drag Session (if any) and Destroys the Pooled Gizmos
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 
 	//Gets the UFocusable Object. If ComponentBased, returns the UFocusable Component or nullptr (if it doesn't implement)
 	// if ActorBased, returns the UFosuable Owner Actor or nullptr (if it doesn't implement)
 	class UObject* GetUFocusable(class USceneComponent* Component) const;
 
+	//Same as GetUFocusable, but for Selected Components it uses what was resolved when they were Selected
+	class UObject* GetSelectedFocusable(class USceneComponent* Component) const;
+
+	//Delivers the Transforms gathered for Focusable Objects that want them in batches (one call per Focusable Object)
+	void FlushFocusableTransformations();
+
 	//Sets the Transform for a Given Component and calls the 
 	//Ufocusable transform function called if it implements the Interface
 	void SetTransform(class USceneComponent* Component, const FTransform& Transform);
 
+	//Same as above, but with the UFocusable Object already resolved (nullptr if it doesn't implement it)
+	void SetTransform(class USceneComponent* Component, class UObject* FocusableObject, const FTransform& Transform);
+
+	/*
+	 * Sets the World Transform of the Component. While a Drag Session with deferred overlaps is active
+	 * (@see bDeferOverlapsWhileDragging) the Component To World is updated directly, skipping the Move path
+	 * (and so the Overlap updates), which are reconciled once when the Session ends.
+	 */
+	void SetComponentWorldTransform(class USceneComponent* Component, const FTransform& Transform);
+
 	//Called when the Component is added to the SelectedComponent List
 	// Calls the IFocusableObject::Focus if the Component implements the UFocusable interface
+	// and caches the UFocusable Object of the Component (@see GetSelectedFocusable)
 	void Select(class USceneComponent* Component, bool* bImplementsUFocusable = nullptr);
 
 	// Called when the Component is removed from the SelectedComponent List
@@ -86,10 +215,80 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void ClearDomain();
 
+	/**
+	 * Cancels the Transform in Progress (if any):
+	 * the Components are restored to the exact Transform & Mobility they had when the Transform started
+	 * (even if the Selection changed mid-drag, for the ones that stayed Selected) and the Current Domain is set to NONE.
+	 * Only local: @see ReplicateCancelTransform
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void CancelTransform();
+
 	//Gets the Start and End Points of the Mouse based on the Player Controller possessing this pawn
 	// returns true if outStartPoint and outEndPoint were given a successful value
 	bool GetMouseStartEndPoints(float TraceDistance, FVector& outStartPoint, FVector& outEndPoint);
 
+	/**
+	 * Picks the Gizmo Handles in closed form (@see ABaseGizmo::TraceDomain) if bAnalyticGizmoPicking,
+	 * setting the Domain if one is hit (unless the Gizmo is ignored).
+	 * @return whether a Gizmo Domain was hit
+	 */
+	bool TraceGizmoDomain(const FVector& StartLocation, const FVector& EndLocation, const TArray<AActor*>& IgnoredActors);
+
+	//Same as TraceGizmoDomain, regardless of bAnalyticGizmoPicking
+	bool PickGizmoDomain(const FVector& StartLocation, const FVector& EndLocation);
+
+	//Traces only the Collision Components of the Gizmo (first phase of bTwoPhasePicking). Sets the Domain if one is hit
+	bool PickGizmoComponents(const FVector& StartLocation, const FVector& EndLocation);
+
+	//Sets the Domain hit in the Gizmo (same as hitting the Gizmo in HandleTracedObjects). Returns false for None
+	bool SetTracedGizmoDomain(ETransformationDomain Domain);
+
+	//Ignores the Gizmo and the Pooled Gizmos in the Query (second phase of bTwoPhasePicking)
+	void AddGizmosToIgnore(FCollisionQueryParams& outQueryParams) const;
+
+	/**
+	 * The Component HandleTracedObjects would Select for the Hit (the Instanced Mesh for an Instance Hit),
+	 * or null if it's a Gizmo. ShouldSelect is not asked here.
+	 */
+	class USceneComponent* GetHitSelectionComponent(const FHitResult& HitResult, bool& bOutInstanceHit) const;
+
+	/**
+	 * Selects the first Hit that ShouldSelect accepts (asking it once per Hit, and only until one is accepted).
+	 * Used by the second phase of bTwoPhasePicking, where the Gizmos were already traced.
+	 * @return false if no Hit is Selectable
+	 */
+	bool SelectFirstSelectableHit(const TArray<FHitResult>& HitResults, bool bAppendToList);
+
+	/**
+	 * Handles the single Hit of the second phase of bTwoPhasePicking.
+	 * @return false if the Hit is not Selectable, so the Multi Trace has to be done instead
+	 */
+	bool HandleTracedHit(const FHitResult& HitResult, bool bAppendToList);
+
+	/**
+	 * Issues the Query as a World Async Trace, tagged with a new AsyncTraceTag so that
+	 * the results of any Async Trace still in flight are dropped.
+	 * The Gizmo is still picked right away in closed form (if bAnalyticGizmoPicking).
+	 * @return whether the Trace was issued (or already finished on the Gizmo)
+	 */
+	bool StartAsyncTrace(const FTransformerTraceQuery& Query, const TArray<AActor*>& IgnoredActors
+		, EAsyncTraceStage Stage);
+
+	//Bound to AsyncTraceDelegate. Called by the World on the frame after the Async Trace was issued
+	void OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	//Does what is left after the Pending Async Trace (depending on its Stage) and calls OnAsyncTraceCompleted
+	void FinishAsyncTrace(bool bTraceSuccessful);
+
+	/**
+	 * Deprojects the Screen Rectangle into the Planes of a Frustum (4 sides + near & far planes)
+	 * with the Player Controller possessing this pawn. Works for Perspective and Orthographic Views.
+	 * returns true if the outFrustumPlanes were given a successful value
+	 */
+	bool GetMarqueeFrustumPlanes(const FVector2D& ScreenStart, const FVector2D& ScreenEnd
+		, float TraceDistance, TArray<FPlane>& outFrustumPlanes);
+
 	/**
 	 * If a Gizmo is Present, (i.e. there is a Selected Object), then
 	 * this test will prioritize finding a Gizmo, even if it is behind an object.
@@ -211,6 +410,117 @@ public:
 		, TArray<AActor*> IgnoredActors
 		, bool bAppendToList = false);
 
+	/**
+	 * Same as MouseTraceByChannel, but traces the Selection Index instead of the Physics Scene,
+	 * so only Registered Selectables can be selected, whether they have Collision or not.
+	 * The Gizmo is always picked in closed form here (@see ABaseGizmo::TraceDomain)
+
+	 * This function only does the actual trace if there is a Player Controller Set
+
+	 * @param bAppendToList - If a selection happens, whether to append to the previously selected components or not
+	 * @return bool Whether there was an Object traced successfully
+	 @see RegisterSelectable
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool MouseTraceBySelectionIndex(float TraceDistance, bool bAppendToList = false);
+
+	/**
+	 * Same as MouseTraceByObjectTypes, but the Trace is done by the World Async Trace,
+	 * so the Game Thread doesn't wait for it. The Selection happens on the next frame,
+	 * and OnAsyncTraceCompleted is called then.
+	 * If another Async Trace is issued before this one completes, this one is dropped.
+
+	 * @see MouseTraceByObjectTypes for Param Desc
+	 * @return bool Whether the Trace was issued
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool AsyncMouseTraceByObjectTypes(float TraceDistance
+		, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+		, TArray<AActor*> IgnoredActors
+		, bool bAppendToList = false);
+
+	/**
+	 * Same as MouseTraceByChannel, but the Trace is done by the World Async Trace.
+	 * @see AsyncMouseTraceByObjectTypes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool AsyncMouseTraceByChannel(float TraceDistance
+		, TEnumAsByte<ECollisionChannel> TraceChannel
+		, TArray<AActor*> IgnoredActors
+		, bool bAppendToList = false);
+
+	/**
+	 * Same as MouseTraceByProfile, but the Trace is done by the World Async Trace.
+	 * @see AsyncMouseTraceByObjectTypes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool AsyncMouseTraceByProfile(float TraceDistance
+		, const FName& ProfileName
+		, TArray<AActor*> IgnoredActors
+		, bool bAppendToList = false);
+
+	/**
+	 * Same as TraceByChannel, but traces the Selection Index instead of the Physics Scene.
+	 * Components are hit by their Bounds (oriented with the Component), not by their Collision.
+
+	 * Note: This function does not Deselect the Objects selected if Trace doesn't select anything in any situation
+
+	 * @param StartLocation - the starting Location of the trace, in World Space
+	 * @param EndLocation - the ending location of the trace, in World Space
+	 * @param bAppendToList - If a selection happens, whether to append to the previously selected components or not
+	 * @return bool Whether there was an Object traced successfully
+	 @see RegisterSelectable
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool TraceBySelectionIndex(const FVector& StartLocation
+		, const FVector& EndLocation
+		, bool bAppendToList = false);
+
+	/**
+	 * Adds the Component to the Selection Index, so that it can be picked by TraceBySelectionIndex
+	 * without having any Collision. The Index follows the Component when it moves.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void RegisterSelectable(class UPrimitiveComponent* Component);
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void UnregisterSelectable(class UPrimitiveComponent* Component);
+
+	//Registers every Primitive Component of the Actor. @see RegisterSelectable
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void RegisterSelectableActor(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void UnregisterSelectableActor(AActor* Actor);
+
+	/**
+	 * Selects the Registered Selectables inside the Screen Rectangle (Marquee) given by two opposite corners.
+	 * The Rectangle is deprojected into a Frustum, which is tested against the Selection Index.
+	 * Everything is done in one Selection Batch, so the Gizmo is updated once.
+
+	 * This function only does the actual selection if there is a Player Controller Set
+
+	 * @param ScreenStart - a corner of the Rectangle, in Screen (Viewport) Space
+	 * @param ScreenEnd - the opposite corner of the Rectangle, in Screen (Viewport) Space
+	 * @param TraceDistance - how far from the Camera the Frustum reaches
+	 * @param Mode - how the Objects in the Marquee are combined with the current Selection
+	 * @return bool Whether the Frustum could be built
+	 @see RegisterSelectable
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool MarqueeSelect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, float TraceDistance
+		, EMarqueeSelectionMode Mode = EMarqueeSelectionMode::MS_Replace);
+
+	/**
+	 * Selects the Registered Selectables whose Bounds intersect the Frustum (or any Convex Volume).
+	 * If Actor Based, the Actors owning the Components found are selected instead.
+	 * @param FrustumPlanes - the Planes of the Volume, with their Normals pointing outwards
+	 * @param Mode - how the Objects in the Frustum are combined with the current Selection
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SelectInFrustum(const TArray<FPlane>& FrustumPlanes
+		, EMarqueeSelectionMode Mode = EMarqueeSelectionMode::MS_Replace);
+
 	// Update every Frame
 	// Checks for Mouse Update
 	virtual void Tick(float DeltaSeconds) override;
@@ -232,6 +542,12 @@ public:
 	FTransform UpdateTransform(const FVector& LookingVector
 		, const FVector& RayOrigin, const FVector& RayDirection);
 
+	/**
+	 * Applies a Delta Transform to the Selected Components.
+	 * If a Transform is in Progress, the Delta is added to the Total Delta of the Drag
+	 * and the Components are transformed from where they were when the Drag started.
+	 * Otherwise the Delta is applied once to the current Transforms of the Components.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void ApplyDeltaTransform(const FTransform& DeltaTransform);
 
@@ -265,6 +581,34 @@ public:
 		//this should be overriden for custom logic
 	}
 
+	/*
+	 * Called when the Gizmo Handle under the Cursor has changed (only if bHoverGizmo)
+	 * @param GizmoType - the type of Gizmo hovered (Translation, Rotation or Scale)
+	 * @param HoveredDomain - the Domain of the Handle under the Cursor, or None if the Cursor left the Handles
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "Runtime Transformer")
+	void OnGizmoHoverChanged(ETransformationType GizmoType, ETransformationDomain HoveredDomain);
+
+	virtual void OnGizmoHoverChanged_Implementation(ETransformationType GizmoType, ETransformationDomain HoveredDomain)
+	{
+		//this should be overriden for custom logic
+	}
+
+	/*
+	 * Called when an Async Trace (@see AsyncMouseTraceByChannel) has completed and its results were handled.
+	 * For the Replicated Async Traces, this is called once the Local part completes
+	 * (the Server part arrives as a regular Selection replication).
+	 * Async Traces that were dropped because a newer one was issued do not call this.
+	 * @param bTraceSuccessful - whether something was Selected or a Gizmo Domain was hit
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "Runtime Transformer")
+	void OnAsyncTraceCompleted(bool bTraceSuccessful);
+
+	virtual void OnAsyncTraceCompleted_Implementation(bool bTraceSuccessful)
+	{
+		//this should be overriden for custom logic
+	}
+
 	/*
 	 * Called when a new Component has been Selected (Focused)
 	 * or has been unselected (unfocused).
@@ -286,6 +630,64 @@ public:
 		//This should be overriden for custom logic
 	}
 
+	/*
+	 * Called once per Selection Batch with all the Components that were added and removed.
+	 * Every Selection function (Select, Deselect, DeselectAll, etc) is a batch by itself,
+	 * unless it is called inside a bigger batch (@see BeginSelectionBatch).
+
+	 * A Component that was selected and then deselected within the same batch (or viceversa) is not reported.
+
+	 * @param AddedComponents - the Components that were selected, in the order they were selected
+	 * @param RemovedComponents - the Components that were deselected
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = "Runtime Transformer")
+	void OnSelectionChanged(const TArray<class USceneComponent*>& AddedComponents
+		, const TArray<class USceneComponent*>& RemovedComponents);
+
+	virtual void OnSelectionChanged_Implementation(const TArray<class USceneComponent*>& AddedComponents
+		, const TArray<class USceneComponent*>& RemovedComponents)
+	{
+		//This should be overriden for custom logic
+	}
+
+	/**
+	 * Starts a Selection Batch. While a batch is open, the Gizmo Placement is deferred
+	 * and the Selection Changes are gathered, until the matching EndSelectionBatch is called.
+	 * Batches can be nested, only the outermost EndSelectionBatch updates the Gizmo and calls OnSelectionChanged.
+
+	 * Every BeginSelectionBatch MUST be matched with an EndSelectionBatch.
+	 * In C++, FScopedSelectionBatch can be used instead.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void BeginSelectionBatch();
+
+	/**
+	 * Ends a Selection Batch. If this was the outermost batch, the Gizmo Placement is updated (once)
+	 * and OnSelectionChanged is called (once) with all the Components added and removed during the batch.
+	 * @see BeginSelectionBatch
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void EndSelectionBatch();
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool IsInSelectionBatch() const { return SelectionBatchDepth > 0; }
+
+	/*
+	 * Same as OnSelectionChanged, but for the Instances selected/deselected (@see SelectInstance)
+
+	 * @param AddedInstances - the Instances that were selected, in the order they were selected
+	 * @param RemovedInstances - the Instances that were deselected
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = "Runtime Transformer")
+	void OnInstanceSelectionChanged(const TArray<FSelectedInstance>& AddedInstances
+		, const TArray<FSelectedInstance>& RemovedInstances);
+
+	virtual void OnInstanceSelectionChanged_Implementation(const TArray<FSelectedInstance>& AddedInstances
+		, const TArray<FSelectedInstance>& RemovedInstances)
+	{
+		//This should be overriden for custom logic
+	}
+
 public:
 
 	/**
@@ -306,6 +708,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void SetRotateOnLocalAxis(bool bRotateLocalAxis);
 
+	/**
+	 * Whether the Pawn and its Gizmo keep ticking while nothing is being transformed
+
+	 @see bTickWhileIdle
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetTickWhileIdle(bool bInTickWhileIdle);
+
 	/**
 	 * Sets the Current Transformation (Translation, Rotation or Scale)
 	 */
@@ -340,7 +750,15 @@ public:
 	void GetSelectedComponents(TArray<class USceneComponent*>& outComponentList
 		, class USceneComponent*& outGizmoPlacedComponent) const;
 
-	TArray<class USceneComponent*> GetSelectedComponents() const;
+	//Gets a Read-Only view of the Selected Components, in the order they were selected (no copy is made)
+	const TArray<class USceneComponent*>& GetSelectedComponents() const;
+
+	/**
+	 * Gets a Read-Only view of the Selected Components that do NOT have a Selected Ancestor moving them (the topmost ones).
+	 * These are the only Components that get transformed, as the rest follow them through Attachment.
+	 * Selected Focusables, and Descendants of Ancestors that are not Movable, are always Roots.
+	 */
+	const TArray<class USceneComponent*>& GetSelectedRoots() const;
 
 	/*
 	* Makes an exact copy of the Actors that are owners of the components and makes
@@ -425,30 +843,81 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	TArray<class USceneComponent*> DeselectAll(bool bDestroyDeselected = false);
 
+	/*
+	 * Selects a single Instance of an Instanced Static Mesh Component, rather than the whole Component.
+	 * Selected Instances are transformed alongside the Selected Components.
+	 * Traces select Instances when bSelectInstances is true.
+
+	 * @param Component - the Instanced Static Mesh the Instance belongs to
+	 * @param InstanceIndex - the index of the Instance in the Component
+	 * @param bAppendToList - whether to add the Instance to the Selection, or to replace the Selection with it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SelectInstance(class UInstancedStaticMeshComponent* Component, int32 InstanceIndex, bool bAppendToList = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void DeselectInstance(class UInstancedStaticMeshComponent* Component, int32 InstanceIndex);
+
+	//Gets the list of Selected Instances, in the order they were selected
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void GetSelectedInstances(TArray<FSelectedInstance>& outInstances) const;
+
+	//Gets a Read-Only view of the Selected Instances, in the order they were selected (no copy is made)
+	const TArray<FSelectedInstance>& GetSelectedInstances() const;
+
 private:
 
 	/*
 	The core functionality, but can be called by Selection of Multiple objects
 	so as to not call UpdateGizmo every time
 	*/
-	void AddComponent_Internal(TArray<class USceneComponent*>& OutComponentList
-		, class USceneComponent* Component);
+	void AddComponent_Internal(class USceneComponent* Component);
 
 	/*
 	The core functionality, but can be called by Selection of Multiple objects
 	so as to not call UpdateGizmo every time
 	*/
-	void DeselectComponent_Internal(TArray<class USceneComponent*>& OutComponentList
-		, class USceneComponent* Component);
-	void DeselectComponentAtIndex_Internal(TArray<class USceneComponent*>& OutComponentList
-		, int32 Index);
+	void DeselectComponent_Internal(class USceneComponent* Component);
+
+	/*
+	 * Whether the Component already follows a Selected Ancestor through Attachment
+	 * (i.e. no Component in between, itself included, uses Absolute Location, Rotation or Scale,
+	 * and the Ancestor MovesAttachedChildren). Focusable Components are never covered, as they need OnNewTransformation.
+	 */
+	bool IsCoveredBySelectedAncestor(class USceneComponent* Component) const;
+
+	/*
+	 * Whether transforming the Component moves its Attached Children, i.e. it is Movable (or bForceMobility)
+	 * and it is not a Focusable that is left in place (bTransformUFocusableObjects)
+	 */
+	bool MovesAttachedChildren(class USceneComponent* Component) const;
+
+	//Same as AddComponent_Internal & DeselectComponent_Internal, for Instances
+	void AddInstance_Internal(const FSelectedInstance& Instance);
+	void DeselectInstance_Internal(const FSelectedInstance& Instance);
+
+	/*
+	 * Places the Component the Gizmo is attached to when only Instances are Selected
+	 * (Instances are not Components, so the Gizmo can't be attached to them)
+	 */
+	class USceneComponent* PlaceInstanceGizmoAnchor(const FSelectedInstance& Instance);
+
+	//Updates the Selected Roots after the Component has been added to the Selected Components
+	void AddSelectedRoot_Internal(class USceneComponent* Component);
+
+	//Updates the Selected Roots after the Component has been removed from the Selected Components
+	void RemoveSelectedRoot_Internal(class USceneComponent* Component);
 
 	/**
-	 * Creates / Replaces Gizmo with the Current Transformation.
-	 * It destroys any current active gizmo to replace it.
+	 * Sets the Gizmo for the Current Transformation.
+	 * The gizmo currently active (if any) is disabled and returned to the Gizmo Pool
+	 * and the one matching the Current Transformation is taken from it.
 	*/
 	void SetGizmo();
 
+	//Gets the Gizmo from the Gizmo Pool. The Gizmo is only Spawned if there is none of the given class in the pool.
+	class ABaseGizmo* GetPooledGizmo(UClass* GizmoClass);
+
 	/**
 	 * Updates the Gizmo Placement (Position)
 	 * Called when an object was selected, deselected
@@ -461,6 +930,102 @@ private:
 	//Resets the transform to all Zeros (including Scale)
 	static void ResetDeltaTransform(FTransform& Transform);
 
+	//Adds a Delta Transform to an Accumulated one (Rotations are composed, Locations & Scales are added)
+	static void AccumulateDeltaTransform(FTransform& outAccumulatedTransform, const FTransform& DeltaTransform);
+
+	/**
+	 * Takes a Snapshot of the Selected Components (Transforms, Mobility, UFocusable, Physics State)
+	 * so that they are transformed from their start state.
+	 * Called when the Domain leaves NONE, and when the Selection changes mid-drag.
+	 * @param bSingleDelta - whether the Session only lasts for a single Delta (e.g. a replicated one without a Domain)
+	 */
+	void BeginDragSession(bool bSingleDelta = false);
+
+	//Called when the Domain goes back to NONE. Reconciles the Overlaps, Physics and Navigation that were deferred
+	void EndDragSession();
+
+	/**
+	 * Replaces the Static Meshes of the Drag Session Components with Instanced previews (one per mesh)
+	 * that are moved instead of the Components. The Components get their Transforms when the Drag Session ends.
+	 * @see ProxyDragThreshold
+	 */
+	void BuildDragProxy();
+
+	//Moves the Drag Proxy (and the Gizmo's Component) by the Total Delta Transform of the Drag Session
+	void UpdateDragProxy();
+
+	//Clears the Drag Proxy (without committing anything) and shows the hidden Static Meshes back
+	void ReleaseDragProxy();
+
+	//Removes the Drag Session Components from the Navigation until RestoreNavigation is called (@see bDeferNavigationWhileDragging)
+	void DeferNavigation();
+	void RestoreNavigation();
+
+	//Scales the Gizmo Scene based on the Camera of the Local Player
+	void ScaleGizmoToLocalView();
+
+	//Sends the Network Delta Transform of the Drag in progress, at most DragStreamRate times per second
+	void StreamDragSample();
+
+	//Stops Streaming the Drag in progress. The caller sends the Commit that completes it for everyone else
+	void EndDragStream();
+
+	//Moves the Drag Session of a remote Drag to the Delta interpolated from the Samples received
+	void UpdateDragStreamReceiver();
+
+	/**
+	 * Gets the Transforms the Drag Session leaves its Components & Instances with
+	 * (or the current Transforms of the Selected Roots & Instances, if there is no Drag Session)
+	 */
+	void GatherCommittedTransforms(TArray<FTransformerCommittedTransform>& OutTransforms);
+
+	//Sends the Transforms to the Server, in Chunks of TransformCommitChunkSize
+	void ReplicateTransformCommit(const TArray<FTransformerCommittedTransform>& Transforms, bool bStreamed);
+
+	//Sets the Absolute Transforms of the Commit (skipping the Components that could not be resolved)
+	void ApplyTransformCommit(const FTransformerTransformCommit& Commit);
+
+	//Whether there is a Transform, a Commit backlog or a Drag Stream to update this Tick
+	bool IsTickBusy() const;
+
+	/**
+	 * Turns off the Tick of the Pawn while idle without a Gizmo (@see bTickWhileIdle), and turns it back on
+	 * when a Gizmo is shown or a Transform starts.
+	 */
+	void UpdateTickEnabled();
+
+	/**
+	 * Transforms every Component in the Drag Session by the Total Delta Transform of the session.
+	 * This is done in two phases: first all the Target Transforms are calculated (in parallel for big selections
+	 * @see ParallelTransformThreshold), then they are committed to the Components in the Game Thread.
+	 */
+	void ApplyDragSession();
+
+	//First phase of ApplyDragSession. Fills the Target Transforms of the Drag Session
+	void EvaluateDragSession();
+
+	/**
+	 * Second phase of ApplyDragSession. Sets the Target Transforms to the Components that are not up to date (Game Thread only)
+	 * @param bWithinBudget - whether to stop once CommitFrameBudgetMs is spent (if set).
+	 *  Components being looked at & closest to the camera go first, and the rest catch up round robin in later frames.
+	 */
+	void CommitDragSession(bool bWithinBudget = false);
+
+	//Orders the Drag Session Components by their distance to the Local Camera, for Budgeted commits
+	void SortCommitPriority();
+
+	//Takes the Snapshot of the Selected Instances (part of BeginDragSession)
+	void BeginInstanceBatches();
+
+	//Rebuilds the Trees of the Hierarchical Instanced Meshes that were dragged (part of EndDragSession)
+	void EndInstanceBatches();
+
+	//Calculates the Target Transforms of the Selected Instances
+	void EvaluateInstanceBatches();
+
+	//Sets the Target Transforms to the Selected Instances, with one Batch Update per Instanced Mesh
+	void CommitInstanceBatches();
+
 	void SetDomain(ETransformationDomain Domain);
 
 public:
@@ -479,6 +1044,20 @@ public:
 		, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
 		, bool bAppendToList = false);
 
+	/*
+	* Function Similar to MarqueeSelect
+	* Builds the Frustum locally and only sends the Frustum to the Server,
+	* which selects with it and replicates the Selection to everyone.
+	* The Selectables have to be Registered in the Server as well (@see RegisterSelectable)
+
+	* ONLY CALL THIS if the PAWN has a Valid Player Controller.
+	
+	* @see MarqueeSelect for Param Desc
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedMarqueeSelect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, float TraceDistance
+		, EMarqueeSelectionMode Mode = EMarqueeSelectionMode::MS_Replace);
+
 	/*
 	* Function Similar to MouseTraceByChannel
 	* Performs a Local Trace for Gizmos (since they appear differently for each player)
@@ -507,6 +1086,46 @@ public:
 		, const FName& ProfileName
 		, bool bAppendToList = false);
 
+	/*
+	* Function Similar to ReplicatedMouseTraceByObjectTypes
+	* Both the Local Trace and the Server Trace are done by the World Async Trace
+	* (@see AsyncMouseTraceByObjectTypes).
+
+	* ONLY CALL THIS if the PAWN has a Valid Player Controller.
+
+	* @see MouseTraceByObjectTypes for Param Desc
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedAsyncMouseTraceByObjectTypes(float TraceDistance
+		, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+		, bool bAppendToList = false);
+
+	/*
+	* Function Similar to ReplicatedMouseTraceByChannel
+	* Both the Local Trace and the Server Trace are done by the World Async Trace.
+
+	* ONLY CALL THIS if the PAWN has a Valid Player Controller.
+
+	* @see MouseTraceByChannel for Param Desc
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedAsyncMouseTraceByChannel(float TraceDistance
+		, TEnumAsByte<ECollisionChannel> CollisionChannel
+		, bool bAppendToList = false);
+
+	/*
+	* Function Similar to ReplicatedMouseTraceByProfile
+	* Both the Local Trace and the Server Trace are done by the World Async Trace.
+
+	* ONLY CALL THIS if the PAWN has a Valid Player Controller.
+
+	* @see MouseTraceByProfile for Param Desc
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicatedAsyncMouseTraceByProfile(float TraceDistance
+		, const FName& ProfileName
+		, bool bAppendToList = false);
+
 	//Gets the List of Actors that will be ignored in the Server Trace(for now its only the current Gizmo of Actor)
 	//Since the Gizmo trace is handled locally (Gizmo appears differently to each player)
 	TArray<AActor*> GetIgnoredActorsForServerTrace() const;
@@ -555,19 +1174,29 @@ public:
 
 
 	/*
-	 * ServerCall, Reliable. ClearDomain is performed in the Server.
+	 * ServerCall, Reliable. ClearDomain is performed in the Server,
+	 * and replicated to everyone through the Mode State.
 	 * Currently no Validation takes place.
 	 * @ see ClearDomain
+	 * @ see ReplicateModeState
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerClearDomain();
 
 	/*
-	 * Multicast, Reliable. ClearDomain is performed in the Clients.
-	 * @ see ClearDomain
+	 * Selects in the Server with the Frustum built by the Client (@see ReplicatedMarqueeSelect)
+	 * and replicates the resulting Selection to everyone.
 	 */
-	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastClearDomain();
+	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ServerSelectInFrustum(const TArray<FPlane>& FrustumPlanes, EMarqueeSelectionMode Mode);
+
+	/*
+	 * ServerCall, Reliable. Async Trace is performed in the Server,
+	 * and its Results are replicated to everyone once it completes.
+	 * @ see ReplicatedAsyncMouseTraceByChannel
+	 */
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerAsyncTrace(const FTransformerTraceQuery& Query);
 
 	/*
 	 * ServerCall, Reliable. ApplyTransform is performed in the Server.
@@ -586,14 +1215,56 @@ public:
 
 	/*
 	 * Calls the ServerClearDomain.
-	 * Then it calls ServerApplyTransform and Resets the Accumulated Network Transform.
+	 * Then it sends the Absolute Transforms of the Selection (in Chunks of TransformCommitChunkSize)
+	 * and Resets the Accumulated Network Transform.
 
 	 * @see ServerClearDomain
-	 * @see ServerApplyTransform
+	 * @see ServerCommitTransforms
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ReplicateFinishTransform();
 
+	/*
+	 * Cancels the Transform in Progress (@see CancelTransform) and calls the ServerClearDomain.
+	 * Then it sends the restored Transforms of the Selection the same way ReplicateFinishTransform does,
+	 * so that everyone that moved with the Drag goes back too.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Replicated Runtime Transformer")
+	void ReplicateCancelTransform();
+
+	/*
+	 * ServerCall, Unreliable. Relays the Drag Sample to everyone (@see bStreamDragTransforms)
+	 */
+	UFUNCTION(Server, Unreliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerStreamDragSample(const FTransformerDragSample& Sample);
+
+	/*
+	 * Multicast, Unreliable. The Pawns that are not Dragging interpolate to the Sample
+	 */
+	UFUNCTION(NetMulticast, Unreliable, Category = "Replicated Runtime Transformer")
+	void MulticastStreamDragSample(const FTransformerDragSample& Sample);
+
+	/*
+	 * ServerCall, Reliable. Only the Transforms of what this Pawn has Selected in the Server are kept,
+	 * and relayed to everyone (@see ReplicateFinishTransform)
+	 */
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Replicated Runtime Transformer")
+	void ServerCommitTransforms(const FTransformerTransformCommit& Commit);
+
+	/*
+	 * Multicast, Reliable. The Pawns that are not Dragging set the Absolute Transforms of the Commit
+	 * (ending the Drag Stream, if it was Streamed).
+	 */
+	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
+	void MulticastCommitTransforms(const FTransformerTransformCommit& Commit);
+
+	/*
+	 * How many Bytes per second the Drag in progress is Streaming (@see bStreamDragTransforms).
+	 * Only the Sample payload is counted (not the RPC & Packet overhead). Refreshed every second, 0 if not Streaming.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Replicated Runtime Transformer")
+	float GetDragStreamBytesPerSecond() const { return DragStreamSender.BytesPerSecond; }
+
 	/*
 	 * ServerCall, Reliable. DeselectAll is performed in the Server.
 	 * Currently no Validation takes place.
@@ -611,65 +1282,45 @@ public:
 
 
 	/*
-	 * ServerCall, Reliable. SetSpaceType is performed in the Server.
+	 * ServerCall, Reliable. SetSpaceType is performed in the Server,
+	 * and replicated to everyone through the Mode State.
 	 * Currently no Validation takes place.
 	 * @ see SetSpaceType
+	 * @ see ReplicateModeState
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerSetSpaceType(ESpaceType Space);
 
 	/*
-	 * Multicast, Reliable. SetSpaceType is performed in the Clients.
-	 * @ see SetSpaceType
-	 */
-	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastSetSpaceType(ESpaceType Space);
-
-	/*
-	 * ServerCall, Reliable. SetTransformationType is performed in the Server.
+	 * ServerCall, Reliable. SetTransformationType is performed in the Server,
+	 * and replicated to everyone through the Mode State.
 	 * Currently no Validation takes place.
 	 * @ see SetTransformationType
+	 * @ see ReplicateModeState
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerSetTransformationType(ETransformationType Transformation);
 
 	/*
-	 * Multicast, Reliable. SetTransformationType is performed in the Clients.
-	 * @ see SetTransformationType
-	 */
-	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastSetTransformationType(ETransformationType Transformation);
-
-	/*
-	 * ServerCall, Reliable. SetComponentBased is performed in the Server.
+	 * ServerCall, Reliable. SetComponentBased is performed in the Server,
+	 * and replicated to everyone through the Mode State.
 	 * Currently no Validation takes place.
 	 * @ see SetComponentBased
+	 * @ see ReplicateModeState
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerSetComponentBased(bool bIsComponentBased);
 
 	/*
-	 * Multicast, Reliable. SetComponentBased is performed in the Clients.
-	 * @ see SetComponentBased
-	 */
-	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastSetComponentBased(bool bIsComponentBased);
-
-	/*
-	 * ServerCall, Reliable. SetRotateOnLocalAxis is performed in the Server.
+	 * ServerCall, Reliable. SetRotateOnLocalAxis is performed in the Server,
+	 * and replicated to everyone through the Mode State.
 	 * Currently no Validation takes place.
 	 * @ see SetRotateOnLocalAxis
+	 * @ see ReplicateModeState
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerSetRotateOnLocalAxis(bool bRotateLocalAxis);
 
-	/*
-	 * Multicast, Reliable. SetRotateOnLocalAxis is performed in the Clients.
-	 * @ see SetRotateOnLocalAxis
-	 */
-	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastSetRotateOnLocalAxis(bool bRotateLocalAxis);
-
 	/*
 	* ServerCall, Reliable. CloneSelected is performed in the Server.
 	* Currently no Validation takes place. 
@@ -677,38 +1328,25 @@ public:
 	* WARNING: Component Cloning will NOT take place. (PluginLimitations.txt for details)
 
 	* NOTE: The Objects must be Replicating in order to be reflected in the Clients.
-	* Objects that are cloned are NOT directly handled but rather a Timer is used to check
-	* when the objects have finished beginplay, so that we are sure that the networking logic has been processed for them
+	* The Clones are Selected (and replicated) right away. Clients that don't have them yet
+	* Select each of them as soon as it arrives (@see ResolveMissingSelection)
 
 	* @ see CloneSelected
-	* @ see CheckUnreplicatedActors
 	*/
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerCloneSelected(bool bSelectNewClones = true
 		, bool bAppendToList = false);
-	
-	/*
-	 * A function called by a Timer that checks when a List of Actors have BegunPlay
-	 * and have been replicated. Once all Actors that are on the Unreplicated list have been processed,
-	 * the remaining functions such as MulticastSetSelectedComponents are called.
-	 */
-	void CheckUnreplicatedActors();
 
 	/*
-	 * ServerCall, Reliable. SetDomain is performed in the Server.
+	 * ServerCall, Reliable. SetDomain is performed in the Server,
+	 * and replicated to everyone through the Mode State.
 	 * Currently no Validation takes place.
 	 * @ see SetDomain
+	 * @ see ReplicateModeState
 	 */
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Replicated Runtime Transformer")
 	void ServerSetDomain(ETransformationDomain Domain);
 
-	/*
-	 * Multicast, Reliable. SetDomain is performed in the Clients.
-	 * @ see SetDomain
-	 */
-	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
-	void MulticastSetDomain(ETransformationDomain Domain);
-
 	/*
 	 * ServerCall, Reliable. Multicasts the Selected Components of the Server to all Clients.
 	 * Currently no Validation takes place.
@@ -723,8 +1361,72 @@ public:
 	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
 	void MulticastSetSelectedComponents(const TArray<USceneComponent*>& Components);
 
-	//Tries to resync the Selections 
-	void ResyncSelection();
+	/*
+	 * Copies the current Space Type, Transformation Type, Component Based, Rotate on Local Axis and Domain
+	 * to the Mode State, marking it Dirty (Push Model) only if something changed. Caller needs to be Server.
+	 */
+	void ReplicateModeState();
+
+	/*
+	 * Applies what changed in the Mode State in the Clients.
+	 * The Domain is not applied to the Locally Controlled Pawn, as it is the one that drives it.
+	 */
+	UFUNCTION()
+	void OnRep_ModeState();
+
+	/*
+	 * Asks the Server for a Snapshot of the Selection, unless one was already asked for.
+	 * Used when the Selection can't be fixed with what was received (a missed Delta, an unexpected Count).
+	 */
+	void RequestSelectionSnapshot();
+
+	/*
+	 * Called when a Replicated Actor arrives in a Client that is missing part of the Selection.
+	 * Waits a Tick so that the Actor and its Components are registered in the Package Map
+	 */
+	void OnActorSpawned(AActor* Actor);
+
+	/*
+	 * Selects the Missing Selection that can now be resolved, and gives up on what has been Missing for longer
+	 * than MissingSelectionTimeout. Also retried every MissingSelectionRetryInterval while anything is Missing,
+	 * as Components of Actors that already exist (e.g. added at runtime) arrive without spawning an Actor.
+	 */
+	void ResolveMissingSelection();
+
+	/*
+	 * Replicates the changes of the Selection since the last time it was replicated, as Deltas
+	 * (in Chunks of SelectionChunkSize). Caller needs to be Server.
+	 */
+	void ReplicateSelection();
+
+	//Replicates the whole Selection as a Snapshot at a new Sequence (in Chunks of SelectionChunkSize). Caller needs to be Server
+	void ReplicateSelectionSnapshot();
+
+	/*
+	 * Multicast, Reliable. Applies the Selection Delta in the Clients,
+	 * or asks for a Snapshot if the Client is not at its Base Sequence.
+	 */
+	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
+	void MulticastSelectionDelta(const FTransformerSelectionDelta& Delta);
+
+	/*
+	 * Multicast, Reliable. Gathers the Chunks of the Snapshot in the Clients
+	 * and sets the Selection to it once the last one arrives.
+	 */
+	UFUNCTION(NetMulticast, Reliable, Category = "Replicated Runtime Transformer")
+	void MulticastSelectionSnapshot(const FTransformerSelectionSnapshot& Snapshot);
+
+	//Selects & Deselects the Components received (without toggling nor ShouldSelect, as the Server already did)
+	void ApplySelectionChange(const TArray<USceneComponent*>& Added, const TArray<USceneComponent*>& Removed);
+
+	/*
+	 * Compares the Selection Count (including the Missing Selection) to the one of the Server,
+	 * and asks for a Snapshot if they are different (and a Snapshot can fix it).
+	 */
+	void CheckSelectionCount(int32 ServerSelectedCount, bool bCanRequestSnapshot);
+
+	//Updates the Missing Selection with what could not be resolved from a Delta / Snapshot
+	void UpdateMissingSelection(const TArray<FNetworkGUID>& Unresolved, const TArray<FNetworkGUID>& UnresolvedRemoved);
 
 	//Networking Variables
 private:
@@ -739,28 +1441,81 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
 	bool bIgnoreNonReplicatedObjects;
 
-	/*
-	 * Optional minimum time to wait for all Cloned objects to fully replicate and are selectable.
-	 * It is not required, but there are occassions (especially when cloning multiple objects at once)
-	 * where the newly spawned clone objects are not selected on the client side because the object, 
-	 * although has begun play, is not still fully network addressable on the client side and so a nullptr is passed 
-	 * (so no selection occurs).
-	 * The time it actually takes to Replicate can be more because it also waits for all clone objects to have begun play.
-	*/
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
-	float MinimumCloneReplicationTime;
+	//The Mode of the Server Pawn, which Clients follow (@see ReplicateModeState)
+	UPROPERTY(ReplicatedUsing = OnRep_ModeState)
+	FTransformerModeState ModeState;
 
-	//The frequency at which checks are done on newly spawned clones. Whether they are suitable for replication.
+	/**
+	 * Whether the Network Delta Transform is streamed (unreliably & quantized) while Dragging,
+	 * so that everyone else sees the Drag live (interpolated), instead of only seeing the result when it finishes.
+	 * ReplicateFinishTransform still sends the whole Delta reliably, so everyone ends up with the same Transforms.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true"))
-	float CloneReplicationCheckFrequency;
+	bool bStreamDragTransforms;
 
-	FTransform	NetworkDeltaTransform;
+	//How many Drag Samples are sent per second while Dragging (@see bStreamDragTransforms)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	float DragStreamRate;
 
-	//List of clone actor/components that need replication but haven't been replicated yet
-	TArray<class USceneComponent*> UnreplicatedComponentClones;
+	/**
+	 * Maximum amount of Transforms sent in a single Commit when a Drag finishes (@see ReplicateFinishTransform).
+	 * Larger Selections are split into several Commits, so no single RPC gets too big.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "4096"))
+	int32 TransformCommitChunkSize;
 
-	FTimerHandle	CheckUnrepTimerHandle;
-	FTimerHandle	ResyncSelectionTimerHandle;
+	//Maximum amount of Components sent in a single Selection Delta or Snapshot (@see ReplicateSelection)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "4096"))
+	int32 SelectionChunkSize;
+
+	//[Client] How often (in seconds) the Missing Selection is retried while anything is Missing (@see ResolveMissingSelection)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "0.01"))
+	float MissingSelectionRetryInterval;
+
+	/*
+	 * [Client] How long (in seconds) a Selected Component can be Missing before it is no longer waited for.
+	 * It then stops counting as Selected, so the next Selection Count mismatch asks the Server for a Snapshot.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replicated Runtime Transformer", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float MissingSelectionTimeout;
+
+	//Clones are now Selected in each Client as soon as they arrive (@see ResolveMissingSelection)
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Clones are Selected as soon as they arrive. Use MissingSelectionTimeout instead"))
+	float MinimumCloneReplicationTime_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Clones are Selected as soon as they arrive. Use MissingSelectionRetryInterval instead"))
+	float CloneReplicationCheckFrequency_DEPRECATED;
+
+	//[Server] The Selection as of the last Selection Delta / Snapshot sent, and its Sequence
+	TSet<class USceneComponent*> ReplicatedSelection;
+	uint32 SelectionSequence;
+
+	//[Client] The Sequence of the last Selection Delta / Snapshot applied
+	uint32 ReceivedSelectionSequence;
+
+	//[Client] Whether a Snapshot was asked for, so Deltas are dropped until it arrives
+	bool bAwaitingSelectionSnapshot;
+
+	//[Client] The Chunks of the Snapshot received so far
+	TArray<class USceneComponent*> PendingSelectionSnapshot;
+	TArray<FNetworkGUID> PendingSnapshotUnresolved;
+
+	/*
+	 * [Client] Components Selected in the Server that haven't arrived here yet (by Network GUID),
+	 * and when (in seconds) each went Missing.
+	 * Each is Selected as soon as it can be resolved, without asking the Server again.
+	 */
+	TMap<FNetworkGUID, double> MissingSelection;
+	bool bResolveMissingSelectionPending;
+	FTimerHandle MissingSelectionRetryHandle;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+	FTransform	NetworkDeltaTransform;
+
+	//Drag Samples sent by this Pawn (if Locally Controlled) and received from it (everywhere else)
+	FTransformerDragStreamSender DragStreamSender;
+	FTransformerDragStreamReceiver DragStreamReceiver;
 
 
 	//Other Vars
@@ -800,6 +1555,22 @@ private:
 	UPROPERTY()
 	TWeakObjectPtr<class ABaseGizmo> Gizmo;
 
+	/**
+	 * One Gizmo per Gizmo Class, lazily spawned.
+	 * Switching Transformations or emptying the Selection just disables the gizmo
+	 * and returns it here, rather than destroying it.
+	 */
+	UPROPERTY()
+	TMap<UClass*, TWeakObjectPtr<class ABaseGizmo>> GizmoPool;
+
+	//Root of the Drag Proxy. Created on the first Proxy Drag and kept for the next ones
+	UPROPERTY()
+	class USceneComponent* DragProxyRoot;
+
+	//Instanced Meshes of the Drag Proxy (one per Static Mesh). Emptied & hidden (not destroyed) when not dragging
+	UPROPERTY()
+	TMap<class UStaticMesh*, class UInstancedStaticMeshComponent*> DragProxyMeshes;
+
 	// Tell which Domain is Selected. If NONE, then that means that there is no Selected Objects, or
 	// that the Gizmo has not been hit yet.
 	ETransformationDomain CurrentDomain;
@@ -813,10 +1584,53 @@ private:
 	ETransformationType CurrentTransformation;
 
 	/**
-	 * Array storing Selected Components. Although a quick O(1) removal is needed (like a Set),
-	 * it is Crucial that we maintain the order of the elements as they were selected
+	 * Set storing Selected Components. Membership, Insertion and Removal are O(1)
+	 * while still maintaining the order of the elements as they were selected (crucial for Gizmo Placement)
+	 */
+	TSelectionSet<class USceneComponent*> SelectedComponents;
+
+	/**
+	 * Subset of the Selected Components that are not covered by a Selected Ancestor (see GetSelectedRoots).
+	 * Updated incrementally on Select/Deselect, so Attachment changes of Components that are
+	 * already Selected are not taken into account until they are Selected again.
+	 * Mobility changes are caught by BeginDragSession, which also transforms the Descendants of Roots that don't move.
+	 */
+	TSelectionSet<class USceneComponent*> SelectedRoots;
+
+	//Instances Selected on their own (@see SelectInstance), in the order they were selected
+	TSelectionSet<FSelectedInstance> SelectedInstances;
+
+	//Collision-independent BVH of the Registered Selectables. @see RegisterSelectable
+	FSelectionIndex SelectionIndex;
+
+	//Bound once to OnAsyncTraceDone and handed to every Async Trace
+	FTraceDelegate AsyncTraceDelegate;
+
+	//Tag of the latest Async Trace issued. Async Traces completing with another Tag are stale
+	uint32 AsyncTraceTag;
+
+	//The Query of the latest Async Trace issued, and what is left to do when it completes
+	FTransformerTraceQuery PendingTraceQuery;
+	EAsyncTraceStage PendingTraceStage;
+
+	/**
+	 * The UFocusable Object of each Selected Component (null if it doesn't implement it), resolved when Selected.
+	 * These caches are not UPROPERTYs, so they are kept Weak to not hand out Objects the GC has already destroyed.
 	 */
-	TArray<class USceneComponent*> SelectedComponents;
+	TMap<TWeakObjectPtr<class USceneComponent>, TWeakObjectPtr<class UObject>> SelectedFocusables;
+
+	//The Focusable Objects (of the Selected Components) that want their Transformations in batches, and how many of their Components are Selected
+	TMap<TWeakObjectPtr<class UObject>, int32> BatchedFocusables;
+
+	//Transforms gathered this frame for each of the Batched Focusables. @see FlushFocusableTransformations
+	TMap<TWeakObjectPtr<class UObject>, FPendingFocusableTransformations> PendingFocusableTransformations;
+
+	//What the Gizmo gets attached to when only Instances are Selected. @see PlaceInstanceGizmoAnchor
+	UPROPERTY()
+	class USceneComponent* InstanceGizmoAnchor;
+
+	//The Instance the Instance Gizmo Anchor was placed on
+	FSelectedInstance AnchoredInstance;
 
 	/*
 	* Map storing the Snap values for each transformation
@@ -844,6 +1658,105 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bForceMobility;
 
+	/**
+	 * The Minimum amount of Components being transformed for the Transform calculations to be done in parallel (worker threads).
+	 * Below this, the calculations are done in the Game Thread as the overhead of going wide is not worth it.
+	 * A value of 0 or less disables the parallel calculation.
+
+	 * NOTE: when parallel, Gizmo::GetSnappedTransformPerComponent is called from worker threads,
+	 * so custom Gizmos overriding it must not touch any UObject state.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 ParallelTransformThreshold;
+
+	/**
+	 * Whether Overlaps are NOT updated while dragging. Instead, Overlaps are updated only once (per transformed Component)
+	 * when the transform finishes (or gets cancelled).
+	 * Greatly reduces the cost of dragging many colliding Components, 
+	 * but Begin/End Overlap events will not fire mid-drag (e.g. when going through a Trigger Volume).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bDeferOverlapsWhileDragging;
+
+	/**
+	 * Whether Components Simulating Physics stop simulating (become kinematic) while they are being dragged.
+	 * Their simulation & velocities are restored (and they are woken up) when the transform finishes.
+	 * If false, they keep simulating and get teleported every frame, waking the solver and pushing their neighbors.
+	 * Single Deltas (e.g. replicated ones without a Domain) are always a single teleport, so their bodies keep simulating.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bKinematicWhileDragging;
+
+	/**
+	 * Whether the Navigation Mesh is left untouched while dragging Components that affect Navigation.
+	 * The dragged Components stop affecting Navigation for the drag (so the area they were in is rebuilt once,
+	 * as if they had been removed), and the area they end up in is rebuilt once when it finishes.
+	 * Only applies to actual drags: a single Delta (e.g. a replicated one without a Domain) dirties the Navigation once anyway.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bDeferNavigationWhileDragging;
+
+	/**
+	 * The Minimum amount of Components being dragged for a Proxy to be dragged instead of the Components themselves.
+	 * The Proxy is made of Instanced Static Meshes (one per mesh) of the Static Meshes being dragged,
+	 * and the Components are only transformed once, when the drag finishes.
+	 * Only Static Meshes are previewed: anything else (e.g. Skeletal Meshes, Particles) stays in place until the drag finishes.
+	 * A value of 0 disables the Proxy.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 ProxyDragThreshold;
+
+	/**
+	 * Milliseconds per frame that can be spent setting the Transforms of the dragged Components.
+	 * Components that were recently rendered go first (closest to the camera first, resuming every frame where the last one stopped),
+	 * and the rest catch up in the following frames (@see CommitRoundRobinShare). Every Component gets its exact final Transform when the drag finishes.
+	 * A value of 0 (or less) disables the budget: every Component is transformed every frame.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float CommitFrameBudgetMs;
+
+	/**
+	 * Share of CommitFrameBudgetMs kept for the Components that were not recently rendered,
+	 * so that they catch up even while there are many visible Components out of date.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "1"))
+	float CommitRoundRobinShare;
+
+	/**
+	 * Whether the Pawn (and its Gizmo) do their full Tick while idle, i.e. while nothing is being transformed.
+	 * If false, the Gizmo stops ticking, and the Pawn only checks whether the Camera moved or zoomed
+	 * (to rescale the Gizmo Scene) while a Gizmo is shown. Without a Gizmo, the Pawn stops ticking altogether.
+	 * Note that this also stops the Blueprint Tick of the Pawn while idle without a Gizmo.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bTickWhileIdle;
+
+	/**
+	 * Whether the Gizmo Handles are picked with a closed-form Ray test (@see ABaseGizmo::TraceDomain)
+	 * before (and instead of) the Physics Traces.
+	 * If true, the Gizmo Collision is disabled, so the Gizmo carries no Physics Bodies.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bAnalyticGizmoPicking;
+
+	/**
+	 * Whether the TraceBy functions pick in two phases instead of doing a Multi Trace through the whole Scene:
+	 * first only the Components of the current Gizmo are traced (or the Gizmo is picked in closed form
+	 * if bAnalyticGizmoPicking), and then a Single Trace that ignores the Gizmos looks for the Object to Select.
+	 * The Multi Trace is only done if the first Object hit is not Selectable (e.g. ShouldSelect rejected it).
+	 *
+	 * Note that the Single Trace only returns Blocking Hits, so Objects that just Overlap the Trace are not Selected.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bTwoPhasePicking;
+
+	/**
+	 * Whether to check every frame which Gizmo Handle is under the Cursor (@see OnGizmoHoverChanged).
+	 * Uses the closed-form Ray test, so no Physics Trace is done. Keeps the Pawn ticking while a Gizmo is shown.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bHoverGizmo;
+
 	/*
 	 * This property only matters when multiple objects are selected.
 	 * Whether multiple objects should rotate on their local axes (true) or on the axes the Gizmo is in (false)
@@ -865,6 +1778,14 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bToggleSelectedInMultiSelection;
 
+	/**
+	 * Whether Traces that hit an Instanced Static Mesh Component (e.g. Foliage, HISMs) select the Instance hit
+	 * rather than the whole Component (or Actor).
+	 * @see SelectInstance
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bSelectInstances;
+
 	/*
 	 * Property that checks whether Components are considered in trace 
 	 or the Actors are.
@@ -873,6 +1794,53 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bComponentBased;
 
-	//Whether we need to Sync with Server if there is a mismatch in number of Selections.
-	bool bResyncSelection;
+	//The Snapshot of the Selection for the Transform in progress
+	FTransformerDragSession DragSession;
+
+	/**
+	 * Whether OnComponentSelectionChange should NOT be called for every Component inside a Selection Batch.
+	 * If true, only OnSelectionChanged is called (once per batch), which is way cheaper when selecting/deselecting lots of Components.
+	 * If false, both are called.
+
+	 * @see OnSelectionChanged
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bCoalesceSelectionEvents;
+
+	//How many Selection Batches are currently open. @see BeginSelectionBatch
+	int32 SelectionBatchDepth;
+
+	//Whether the Gizmo Placement was requested during a Selection Batch
+	bool bGizmoPlacementPending;
+
+	//Components Selected/Deselected in the current Selection Batch
+	TSelectionSet<class USceneComponent*> PendingAddedComponents;
+	TSelectionSet<class USceneComponent*> PendingRemovedComponents;
+
+	//Instances Selected/Deselected in the current Selection Batch
+	TSelectionSet<FSelectedInstance> PendingAddedInstances;
+	TSelectionSet<FSelectedInstance> PendingRemovedInstances;
+};
+
+/**
+ * Opens a Selection Batch for the Lifetime of this Scope
+ * @see ATransformerPawn::BeginSelectionBatch
+ */
+struct FScopedSelectionBatch
+{
+	FScopedSelectionBatch(ATransformerPawn* InTransformerPawn)
+		: TransformerPawn(InTransformerPawn)
+	{
+		if (TransformerPawn)
+			TransformerPawn->BeginSelectionBatch();
+	}
+
+	~FScopedSelectionBatch()
+	{
+		if (TransformerPawn)
+			TransformerPawn->EndSelectionBatch();
+	}
+
+private:
+	ATransformerPawn* TransformerPawn;
 };
@@ -36,8 +36,10 @@ public class RuntimeTransformer : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"NetCore",
 				"Slate",
 				"SlateCore",
+				"NavigationSystem",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);